@@ -0,0 +1,119 @@
+#include "Components/GA_RecoilComponent.h"
+
+// Fixed spring step, so the same shots give the same motion at any frame rate
+static constexpr float GA_RecoilStep = 1.f / 240.f;
+static constexpr int32 GA_RecoilMaxSteps = 16;
+
+UGA_RecoilComponent::UGA_RecoilComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Stage = EGA_ProcStage::Recoil;
+
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UGA_RecoilComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BakePreset();
+}
+
+void UGA_RecoilComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	TimeAccumulator = FMath::Min(TimeAccumulator + DeltaTime, GA_RecoilStep * GA_RecoilMaxSteps);
+	while (TimeAccumulator >= GA_RecoilStep)
+	{
+		StepSpring(GA_RecoilStep);
+		TimeAccumulator -= GA_RecoilStep;
+	}
+
+	if (IsSettled())
+	{
+		ResetRecoil();
+	}
+}
+
+void UGA_RecoilComponent::SetRecoilPreset(UGA_RecoilData* NewPreset)
+{
+	if (RecoilPreset != NewPreset)
+	{
+		RecoilPreset = NewPreset;
+		BakePreset();
+	}
+}
+
+void UGA_RecoilComponent::PlayRecoil(int32 ShotSequence, int32 ShotIndex)
+{
+	if (!bEnabled || !IsValid(RecoilPreset)) return;
+
+	FVector3f RotationKick;
+	FVector3f TranslationKick;
+	LUT.GetKick(static_cast<uint16>(ShotSequence), ShotIndex, RotationKick, TranslationKick);
+
+	// A critically damped spring given this impulse peaks at exactly the kick
+	const float Impulse = FMath::Sqrt(Stiffness) * UE_EULERS_NUMBER * RecoilScale;
+	RotationVelocity += RotationKick * Impulse;
+	TranslationVelocity += TranslationKick * Impulse;
+
+	SetComponentTickEnabled(true);
+}
+
+void UGA_RecoilComponent::ResetRecoil()
+{
+	RotationOffset = RotationVelocity = FVector3f::ZeroVector;
+	TranslationOffset = TranslationVelocity = FVector3f::ZeroVector;
+	TimeAccumulator = 0.f;
+
+	SetComponentTickEnabled(false);
+}
+
+bool UGA_RecoilComponent::ComputeOutput(float DeltaSeconds, const UAnimInstance* AnimInstance, const FGA_ProceduralInput& Input, FGA_ProceduralOutput& Out) const
+{
+	if (!IsComponentTickEnabled())
+	{
+		return false;
+	}
+
+	Out.Transform = FTransform(FRotator(RotationOffset.Y, RotationOffset.Z, RotationOffset.X), FVector(TranslationOffset));
+	Out.Weight = 1.f;
+	Out.Stage = EGA_ProcStage::Recoil;
+
+	return true;
+}
+
+void UGA_RecoilComponent::BakePreset()
+{
+	if (!IsValid(RecoilPreset))
+	{
+		return;
+	}
+
+	const FGA_RecoilPattern& Pattern = RecoilPreset->Pattern;
+	LUT.Bake(Pattern);
+	Stiffness = Pattern.SpringStiffness;
+	DampingRatio = Pattern.SpringDampingRatio;
+}
+
+void UGA_RecoilComponent::StepSpring(float DT)
+{
+	const float Damping = 2.f * DampingRatio * FMath::Sqrt(Stiffness);
+
+	// Semi-implicit Euler towards rest
+	RotationVelocity -= (RotationOffset * Stiffness + RotationVelocity * Damping) * DT;
+	RotationOffset += RotationVelocity * DT;
+
+	TranslationVelocity -= (TranslationOffset * Stiffness + TranslationVelocity * Damping) * DT;
+	TranslationOffset += TranslationVelocity * DT;
+}
+
+bool UGA_RecoilComponent::IsSettled() const
+{
+	constexpr float Tolerance = 1.e-3f;
+
+	return RotationOffset.GetAbsMax() < Tolerance && RotationVelocity.GetAbsMax() < Tolerance
+		&& TranslationOffset.GetAbsMax() < Tolerance && TranslationVelocity.GetAbsMax() < Tolerance;
+}
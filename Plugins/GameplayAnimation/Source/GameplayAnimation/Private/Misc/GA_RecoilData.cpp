@@ -0,0 +1,33 @@
+#include "Misc/GA_RecoilData.h"
+
+#include "Math/RandomStream.h"
+
+void FGA_RecoilLUT::Bake(const FGA_RecoilPattern& Pattern)
+{
+	for (int32 i = 0; i < Size; ++i)
+	{
+		Rotation[i] = FVector3f(Pattern.RotationKick.GetValue(static_cast<float>(i)));
+		Translation[i] = FVector3f(Pattern.TranslationKick.GetValue(static_cast<float>(i)));
+	}
+
+	RandomRotation = FVector3f(Pattern.RandomRotation);
+	RandomTranslation = FVector3f(Pattern.RandomTranslation);
+}
+
+void FGA_RecoilLUT::GetKick(uint16 ShotSequence, int32 ShotIndex, FVector3f& OutRotation, FVector3f& OutTranslation) const
+{
+	const int32 Index = FMath::Clamp(ShotIndex, 0, Size - 1);
+
+	// Seeded from the shot sequence like the weapon spread, salted so kick and pellets don't correlate
+	FRandomStream Stream(static_cast<int32>((static_cast<uint32>(ShotSequence) * 2654435761u) ^ 0x9E3779B9u));
+
+	OutRotation = Rotation[Index] + FVector3f(
+		Stream.FRandRange(-RandomRotation.X, RandomRotation.X),
+		Stream.FRandRange(-RandomRotation.Y, RandomRotation.Y),
+		Stream.FRandRange(-RandomRotation.Z, RandomRotation.Z));
+
+	OutTranslation = Translation[Index] + FVector3f(
+		Stream.FRandRange(-RandomTranslation.X, RandomTranslation.X),
+		Stream.FRandRange(-RandomTranslation.Y, RandomTranslation.Y),
+		Stream.FRandRange(-RandomTranslation.Z, RandomTranslation.Z));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/GA_ProceduralMotionComponent.h"
+#include "Misc/GA_RecoilData.h"
+#include "GA_RecoilComponent.generated.h"
+
+/**
+ * Weapon kick for the Recoil stage. Each shot adds its baked kick as an impulse to a damped spring per axis,
+ * so overlapping shots stack without allocating. The spring runs at a fixed step and only ticks while moving.
+ */
+UCLASS(ClassGroup=(GameplayAnimation), meta=(BlueprintSpawnableComponent, DisplayName = "Recoil Component"))
+class GAMEPLAYANIMATION_API UGA_RecoilComponent : public UGA_ProceduralMotionComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGA_RecoilComponent(const FObjectInitializer& ObjectInitializer);
+
+	//~ UActorComponent
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	//~ End of UActorComponent
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Procedural Motion|Recoil")
+	TObjectPtr<UGA_RecoilData> RecoilPreset;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Settings|Procedural Motion|Recoil")
+	float RecoilScale = 1.f;
+
+	UFUNCTION(BlueprintCallable, Category="Procedural Motion|Recoil")
+	void SetRecoilPreset(UGA_RecoilData* NewPreset);
+
+	/** ShotIndex counts shots since the trigger was pressed, ShotSequence seeds the random part. */
+	UFUNCTION(BlueprintCallable, Category="Procedural Motion|Recoil")
+	void PlayRecoil(int32 ShotSequence, int32 ShotIndex);
+
+	UFUNCTION(BlueprintCallable, Category="Procedural Motion|Recoil")
+	void ResetRecoil();
+
+	const FGA_RecoilLUT& GetLUT() const { return LUT; }
+
+protected:
+	virtual bool ComputeOutput(float DeltaSeconds, const UAnimInstance* AnimInstance, const FGA_ProceduralInput& Input, FGA_ProceduralOutput& Out) const override;
+
+private:
+	FGA_RecoilLUT LUT;
+
+	float Stiffness = 400.f;
+	float DampingRatio = 0.7f;
+	float TimeAccumulator = 0.f;
+
+	FVector3f RotationOffset = FVector3f::ZeroVector;
+	FVector3f RotationVelocity = FVector3f::ZeroVector;
+	FVector3f TranslationOffset = FVector3f::ZeroVector;
+	FVector3f TranslationVelocity = FVector3f::ZeroVector;
+
+	void BakePreset();
+	void StepSpring(float DT);
+	bool IsSettled() const;
+};
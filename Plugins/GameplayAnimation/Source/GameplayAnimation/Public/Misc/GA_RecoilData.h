@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Curves/CurveVector.h"
+#include "GA_RecoilData.generated.h"
+
+USTRUCT(BlueprintType)
+struct FGA_RecoilPattern
+{
+	GENERATED_BODY()
+
+	// Kick per shot, X axis is the shot index within a spray. X = Roll, Y = Pitch, Z = Yaw, in degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FRuntimeVectorCurve RotationKick;
+
+	// Kick per shot, X axis is the shot index within a spray. In cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FRuntimeVectorCurve TranslationKick;
+
+	// Added on top of every kick, in +/- range, seeded by the shot sequence
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FVector RandomRotation{FVector::ZeroVector};
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FVector RandomTranslation{FVector::ZeroVector};
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=1.0))
+	float SpringStiffness = 400.f;
+
+	// 1 is critically damped
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.05, ClampMax=2.0))
+	float SpringDampingRatio = 0.7f;
+};
+
+/** RecoilPattern sampled once per shot index, so firing never touches the curves. */
+struct FGA_RecoilLUT
+{
+	static constexpr int32 Size = 32;
+
+	FVector3f Rotation[Size];
+	FVector3f Translation[Size];
+	FVector3f RandomRotation = FVector3f::ZeroVector;
+	FVector3f RandomTranslation = FVector3f::ZeroVector;
+
+	void Bake(const FGA_RecoilPattern& Pattern);
+
+	/** Same result on every machine for the same shot, shots past the table repeat its last entry. */
+	void GetKick(uint16 ShotSequence, int32 ShotIndex, FVector3f& OutRotation, FVector3f& OutTranslation) const;
+};
+
+UCLASS(Blueprintable, BlueprintType)
+class GAMEPLAYANIMATION_API UGA_RecoilData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category=Defaults)
+	FGA_RecoilPattern Pattern;
+
+};
@@ -28,6 +28,7 @@ public class GameplayEquipments : ModuleRules
 				"Core",
 				"GameplayTags",
 				"InputCore",
+				"NetCore",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -39,7 +40,7 @@ public class GameplayEquipments : ModuleRules
 				"CoreUObject",
 				"Engine",
 				"PhysicsCore",
-				"NetCore",
+				"Niagara",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -4,9 +4,36 @@
 #include "GameFramework/Character.h"
 
 #include "Equipments/GE_Equipment.h"
+#include "Subsystems/GE_EquipmentPoolSubsystem.h"
+
+void FGE_EquipmentSlotEntry::PreReplicatedRemove(const FGE_EquipmentSlotList& InArraySerializer)
+{
+	if (InArraySerializer.OwnerComponent)
+	{
+		InArraySerializer.OwnerComponent->HandleSlotRemoved(SlotIndex);
+	}
+}
+
+void FGE_EquipmentSlotEntry::PostReplicatedAdd(const FGE_EquipmentSlotList& InArraySerializer)
+{
+	if (InArraySerializer.OwnerComponent)
+	{
+		InArraySerializer.OwnerComponent->HandleSlotAdded(SlotIndex, Equipment);
+	}
+}
+
+void FGE_EquipmentSlotEntry::PostReplicatedChange(const FGE_EquipmentSlotList& InArraySerializer)
+{
+	// Also where an equipment that hadn't replicated yet when its entry arrived shows up
+	if (InArraySerializer.OwnerComponent)
+	{
+		InArraySerializer.OwnerComponent->HandleSlotAdded(SlotIndex, Equipment);
+	}
+}
 
 UGE_EquipmentManagerComponent::UGE_EquipmentManagerComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, SlotList(this)
 {
 	PrimaryComponentTick.bCanEverTick = false;
 
@@ -17,8 +44,9 @@ void UGE_EquipmentManagerComponent::GetLifetimeReplicatedProps(TArray<FLifetimeP
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UGE_EquipmentManagerComponent, Slots);
+	DOREPLIFETIME(UGE_EquipmentManagerComponent, SlotList);
 	DOREPLIFETIME(UGE_EquipmentManagerComponent, CurrentIndex);
+	DOREPLIFETIME(UGE_EquipmentManagerComponent, FlowState);
 }
 
 void UGE_EquipmentManagerComponent::InitializeComponent()
@@ -39,6 +67,12 @@ void UGE_EquipmentManagerComponent::EndPlay(const EEndPlayReason::Type EndPlayRe
 		GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
 	}
 
+	// Whatever the owner still carries would otherwise be left orphaned in the world
+	if (EndPlayReason == EEndPlayReason::Destroyed && GetOwner() && GetOwner()->HasAuthority())
+	{
+		RemoveEquipments(EGE_EquipmentRemovalReason::OwnerDeath);
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -64,6 +98,11 @@ int32 UGE_EquipmentManagerComponent::AddEquipment(AGE_Equipment* Equipment, int3
 
 	Slots[Slot] = Equipment;
 
+	FGE_EquipmentSlotEntry& Entry = SlotList.Entries.AddDefaulted_GetRef();
+	Entry.Equipment = Equipment;
+	Entry.SlotIndex = Slot;
+	SlotList.MarkItemDirty(Entry);
+
 	Equipment->SetOwningCharacter(GetCharacter());
 	OnEquipmentAdded.Broadcast(Equipment, Slot);
 	return Slot;
@@ -82,19 +121,34 @@ bool UGE_EquipmentManagerComponent::RemoveEquipmentAt(int32 SlotIndex, EGE_Equip
 
 	if (SlotIndex == CurrentIndex)
 	{
+		GetWorld()->GetTimerManager().ClearTimer(FlowTimer);
 		FinishUnequipOnRole(Eq);
 		CurrentIndex = INDEX_NONE;
+		PendingIndex = INDEX_NONE;
+		Server_SetFlowState(EGE_EquipFlowPhase::Idle, INDEX_NONE, INDEX_NONE);
 	}
 
 	Eq->OnBeforeRemoved(this, Reason);
 
 	Slots[SlotIndex] = nullptr;
 
+	const int32 EntryIndex = SlotList.Entries.IndexOfByPredicate([SlotIndex](const FGE_EquipmentSlotEntry& Entry) { return Entry.SlotIndex == SlotIndex; });
+	if (EntryIndex != INDEX_NONE)
+	{
+		SlotList.Entries.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+		SlotList.MarkArrayDirty();
+	}
+
 	OnEquipmentRemoved.Broadcast(Eq, SlotIndex);
 
-	if (bDestroyOnRemove)
+	// Nobody keeps what a dead owner carried, so it's pooled either way
+	if (bDestroyOnRemove || Reason == EGE_EquipmentRemovalReason::OwnerDeath)
 	{
-		Eq->SetLifeSpan(0.01f);
+		UGE_EquipmentPoolSubsystem* Pool = GetWorld()->GetSubsystem<UGE_EquipmentPoolSubsystem>();
+		if (!Pool || !Pool->Release(Eq))
+		{
+			Eq->SetLifeSpan(0.01f);
+		}
 	}
 
 	return true;
@@ -135,18 +189,16 @@ void UGE_EquipmentManagerComponent::Cycle(int32 Delta)
 {
 	if (Delta == 0) return;
 
+	const int32 To = FindNextIndex(Delta);
+	if (To == INDEX_NONE) return;
+
 	if (GetOwner()->HasAuthority())
 	{
-		const int32 To = FindNextIndex(Delta);
-
-		if (To != INDEX_NONE)
-		{
-			BeginServerSwap(To);
-		}
+		BeginServerSwap(To);
 	}
 	else
 	{
-		ServerCycle(Delta);
+		RequestSwap(To);
 	}
 }
 
@@ -160,7 +212,7 @@ void UGE_EquipmentManagerComponent::EquipSlot(int32 SlotIndex)
 	}
 	else
 	{
-		ServerEquipSlot(SlotIndex);
+		RequestSwap(SlotIndex);
 	}
 }
 
@@ -185,6 +237,12 @@ bool UGE_EquipmentManagerComponent::UseFirstPersonLocally() const
 	return P && P->IsLocallyControlled();
 }
 
+bool UGE_EquipmentManagerComponent::IsPredictingFlow() const
+{
+	const APawn* P = GetOwner<APawn>();
+	return P && P->IsLocallyControlled() && !P->HasAuthority();
+}
+
 void UGE_EquipmentManagerComponent::EnsureCapacity()
 {
 	if (MaxSlots <= 0) MaxSlots = 1;
@@ -236,10 +294,9 @@ void UGE_EquipmentManagerComponent::BeginServerSwap(int32 ToIndex)
 		GetWorld()->GetTimerManager().ClearTimer(FlowTimer);
 
 		if (Current) { Current->CancelUnequip(); }
-		MulticastCancelUnequip(CurrentIndex);
 
-		FlowPhase = EGE_EquipFlowPhase::Idle;
 		PendingIndex = INDEX_NONE;
+		Server_SetFlowState(EGE_EquipFlowPhase::Idle, INDEX_NONE, CurrentIndex);
 		return;
 	}
 
@@ -250,12 +307,10 @@ void UGE_EquipmentManagerComponent::BeginServerSwap(int32 ToIndex)
 	// If something is equipped, start unequip phase
 	if (Current)
 	{
-		FlowPhase = EGE_EquipFlowPhase::Unequipping;
 		PendingIndex = ToIndex;
+		Server_SetFlowState(EGE_EquipFlowPhase::Unequipping, CurrentIndex, ToIndex);
 
-		MulticastBeginUnequip(CurrentIndex);
-
-		const float UnequipT = FMath::Max(0.f, StartUnequipOnRole(Current, /*bLocalFP=*/false));
+		const float UnequipT = FMath::Max(0.f, StartUnequipOnRole(Current, UseFirstPersonLocally()));
 		if (UnequipT > UE_KINDA_SMALL_NUMBER)
 		{
 			GetWorld()->GetTimerManager().SetTimer(FlowTimer, this, &UGE_EquipmentManagerComponent::Server_UnequipFinished, UnequipT, false);
@@ -269,14 +324,14 @@ void UGE_EquipmentManagerComponent::BeginServerSwap(int32 ToIndex)
 	}
 
 	// Nothing equipped -> go straight to equip
-	FlowPhase = EGE_EquipFlowPhase::Equipping;
 	PendingIndex = INDEX_NONE;
+	Server_SetFlowState(EGE_EquipFlowPhase::Equipping, INDEX_NONE, ToIndex);
 
-	MulticastBeginEquip(ToIndex);
-
+	const int32 OldIndex = CurrentIndex;
 	CurrentIndex = ToIndex;
+	BroadcastChanged(Next, GetEquipmentAt(OldIndex));
 
-	const float EquipT = FMath::Max(0.f, StartEquipOnRole(Next, /*bLocalFP=*/false));
+	const float EquipT = FMath::Max(0.f, StartEquipOnRole(Next, UseFirstPersonLocally()));
 	if (EquipT > UE_KINDA_SMALL_NUMBER)
 	{
 		GetWorld()->GetTimerManager().SetTimer(FlowTimer, this, &UGE_EquipmentManagerComponent::Server_EquipFinished, EquipT, false);
@@ -300,16 +355,17 @@ void UGE_EquipmentManagerComponent::Server_UnequipFinished()
 	if (!Next)
 	{
 		CurrentIndex = INDEX_NONE;
-		FlowPhase = EGE_EquipFlowPhase::Idle;
+		Server_SetFlowState(EGE_EquipFlowPhase::Idle, INDEX_NONE, INDEX_NONE);
 		return;
 	}
 
-	FlowPhase = EGE_EquipFlowPhase::Equipping;
-	MulticastBeginEquip(ToIndex);
+	Server_SetFlowState(EGE_EquipFlowPhase::Equipping, INDEX_NONE, ToIndex);
 
+	const int32 OldIndex = CurrentIndex;
 	CurrentIndex = ToIndex;
+	BroadcastChanged(Next, GetEquipmentAt(OldIndex));
 
-	const float EquipT = FMath::Max(0.f, StartEquipOnRole(Next, /*bLocalFP=*/false));
+	const float EquipT = FMath::Max(0.f, StartEquipOnRole(Next, UseFirstPersonLocally()));
 	if (EquipT > UE_KINDA_SMALL_NUMBER)
 	{
 		GetWorld()->GetTimerManager().SetTimer(FlowTimer, this, &UGE_EquipmentManagerComponent::Server_EquipFinished, EquipT, false);
@@ -325,7 +381,56 @@ void UGE_EquipmentManagerComponent::Server_EquipFinished()
 	if (!ensure(GetOwner() && GetOwner()->HasAuthority())) return;
 
 	if (AGE_Equipment* NewEq = GetEquipmentAt(CurrentIndex)) { FinishEquipOnRole(NewEq); }
-	FlowPhase = EGE_EquipFlowPhase::Idle;
+	Server_SetFlowState(EGE_EquipFlowPhase::Idle, INDEX_NONE, CurrentIndex);
+}
+
+void UGE_EquipmentManagerComponent::Server_SetFlowState(EGE_EquipFlowPhase Phase, int32 FromIndex, int32 ToIndex)
+{
+	FlowPhase = Phase;
+
+	FlowState.Phase = Phase;
+	FlowState.FromIndex = static_cast<int8>(FromIndex);
+	FlowState.ToIndex = static_cast<int8>(ToIndex);
+}
+
+void UGE_EquipmentManagerComponent::RequestSwap(int32 ToIndex)
+{
+	++LocalRequestId;
+
+	if (IsPredictingFlow())
+	{
+		PredictSwap(ToIndex);
+	}
+
+	ServerEquipSlot(ToIndex, LocalRequestId);
+}
+
+void UGE_EquipmentManagerComponent::PredictSwap(int32 ToIndex)
+{
+	// Same rules as BeginServerSwap, on the local flow
+	if (ToIndex == LocalIndex && (FlowPhase == EGE_EquipFlowPhase::Idle || FlowPhase == EGE_EquipFlowPhase::Equipping))
+	{
+		return;
+	}
+
+	if (FlowPhase == EGE_EquipFlowPhase::Unequipping)
+	{
+		Local_CancelUnequip(LocalIndex);
+		return;
+	}
+
+	if (GetEquipmentAt(LocalIndex))
+	{
+		Local_BeginUnequip(LocalIndex, ToIndex);
+		return;
+	}
+
+	Local_BeginEquip(ToIndex);
+}
+
+int32 UGE_EquipmentManagerComponent::GetPredictedTarget() const
+{
+	return FlowPhase == EGE_EquipFlowPhase::Unequipping ? PendingIndex : LocalIndex;
 }
 
 void UGE_EquipmentManagerComponent::Local_BeginUnequip(int32 FromIndex, int32 ChainToIndex /*= INDEX_NONE*/)
@@ -337,22 +442,27 @@ void UGE_EquipmentManagerComponent::Local_BeginUnequip(int32 FromIndex, int32 Ch
 		const bool bFP = UseFirstPersonLocally();
 		const float T = FMath::Max(0.f, StartUnequipOnRole(Eq, bFP));
 		FlowPhase = EGE_EquipFlowPhase::Unequipping;
+		PendingIndex = ChainToIndex;
 
 		Local_ClearTimer();
-		if (T <= UE_KINDA_SMALL_NUMBER)
+
+		auto Finish = [this, Eq, ChainToIndex]()
 		{
 			FinishUnequipOnRole(Eq);
 			FlowPhase = EGE_EquipFlowPhase::Idle;
-			if (ChainToIndex != INDEX_NONE) Local_BeginEquip(ChainToIndex);
+			PendingIndex = INDEX_NONE;
+
+			if (ChainToIndex != INDEX_NONE) { Local_BeginEquip(ChainToIndex); }
+			else { LocalIndex = INDEX_NONE; }
+		};
+
+		if (T <= UE_KINDA_SMALL_NUMBER)
+		{
+			Finish();
 			return;
 		}
 
-		GetWorld()->GetTimerManager().SetTimer(FlowTimer, [this, Eq, ChainToIndex]()
-		{
-			FinishUnequipOnRole(Eq);
-			FlowPhase = EGE_EquipFlowPhase::Idle;
-			if (ChainToIndex != INDEX_NONE) Local_BeginEquip(ChainToIndex);
-		}, T, false);
+		GetWorld()->GetTimerManager().SetTimer(FlowTimer, FTimerDelegate::CreateWeakLambda(this, Finish), T, false);
 	}
 }
 
@@ -361,6 +471,8 @@ void UGE_EquipmentManagerComponent::Local_BeginEquip(int32 ToIndex)
 	if (!Slots.IsValidIndex(ToIndex)) return;
 	if (AGE_Equipment* Eq = Slots[ToIndex])
 	{
+		Local_SetShownIndex(ToIndex);
+
 		const bool bFP = UseFirstPersonLocally();
 		const float T = FMath::Max(0.f, StartEquipOnRole(Eq, bFP));
 		FlowPhase = EGE_EquipFlowPhase::Equipping;
@@ -373,11 +485,11 @@ void UGE_EquipmentManagerComponent::Local_BeginEquip(int32 ToIndex)
 			return;
 		}
 
-		GetWorld()->GetTimerManager().SetTimer(FlowTimer, [this, Eq]()
+		GetWorld()->GetTimerManager().SetTimer(FlowTimer, FTimerDelegate::CreateWeakLambda(this, [this, Eq]()
 		{
 			FinishEquipOnRole(Eq);
 			FlowPhase = EGE_EquipFlowPhase::Idle;
-		}, T, false);
+		}), T, false);
 	}
 }
 
@@ -398,6 +510,69 @@ void UGE_EquipmentManagerComponent::Local_CancelUnequip(int32 Index)
 		Local_ClearTimer();
 		Eq->CancelUnequip();
 		FlowPhase = EGE_EquipFlowPhase::Idle;
+		PendingIndex = INDEX_NONE;
+	}
+}
+
+void UGE_EquipmentManagerComponent::Local_ApplyFlowState()
+{
+	const int32 From = FlowState.FromIndex;
+	const int32 To = FlowState.ToIndex;
+
+	// Put away whatever the server isn't showing, e.g. a mispredicted swap
+	auto PutAwayShown = [this](int32 Keep)
+	{
+		if (LocalIndex == Keep) return;
+
+		Local_ClearTimer();
+		if (AGE_Equipment* Shown = GetEquipmentAt(LocalIndex)) { FinishUnequipOnRole(Shown); }
+		FlowPhase = EGE_EquipFlowPhase::Idle;
+		PendingIndex = INDEX_NONE;
+		LocalIndex = INDEX_NONE;
+	};
+
+	switch (FlowState.Phase)
+	{
+		case EGE_EquipFlowPhase::Unequipping:
+			if (FlowPhase == EGE_EquipFlowPhase::Unequipping && LocalIndex == From) break;
+
+			PutAwayShown(From);
+			LocalIndex = From;
+			Local_BeginUnequip(From, INDEX_NONE);
+			break;
+
+		case EGE_EquipFlowPhase::Equipping:
+			if (LocalIndex == To && FlowPhase != EGE_EquipFlowPhase::Unequipping) break;
+
+			PutAwayShown(To);
+			Local_BeginEquip(To);
+			break;
+
+		case EGE_EquipFlowPhase::Idle:
+			if (FlowPhase == EGE_EquipFlowPhase::Unequipping && LocalIndex == To)
+			{
+				Local_CancelUnequip(To);
+				break;
+			}
+			if (LocalIndex == To) break;
+
+			// The whole swap happened between two updates
+			PutAwayShown(To);
+			if (To != INDEX_NONE) { Local_BeginEquip(To); }
+			else { Local_SetShownIndex(INDEX_NONE); }
+			break;
+	}
+}
+
+void UGE_EquipmentManagerComponent::Local_SetShownIndex(int32 NewIndex)
+{
+	LocalIndex = NewIndex;
+
+	if (CurrentIndex != NewIndex)
+	{
+		const int32 OldIndex = CurrentIndex;
+		CurrentIndex = NewIndex;
+		BroadcastChanged(GetEquipmentAt(NewIndex), GetEquipmentAt(OldIndex));
 	}
 }
 
@@ -440,59 +615,69 @@ void UGE_EquipmentManagerComponent::BroadcastChanged(AGE_Equipment* NewEq, AGE_E
 	OnEquipmentChanged.Broadcast(NewEq, OldEq);
 }
 
-void UGE_EquipmentManagerComponent::OnRep_Slots()
+void UGE_EquipmentManagerComponent::HandleSlotAdded(int32 SlotIndex, AGE_Equipment* Equipment)
 {
-	if (ACharacter* C = GetCharacter())
+	EnsureCapacity();
+
+	if (!Slots.IsValidIndex(SlotIndex)) return;
+
+	AGE_Equipment* Old = Slots[SlotIndex];
+	if (Old == Equipment) return;
+
+	if (Old)
 	{
-		for (AGE_Equipment* Eq : Slots)
+		Slots[SlotIndex] = nullptr;
+		OnEquipmentRemoved.Broadcast(Old, SlotIndex);
+	}
+
+	Slots[SlotIndex] = Equipment;
+
+	if (Equipment)
+	{
+		if (ACharacter* C = GetCharacter())
 		{
-			if (Eq)
-			{
-				Eq->SetOwningCharacter(C);
-			}
+			Equipment->SetOwningCharacter(C);
 		}
-	}
-}
 
-void UGE_EquipmentManagerComponent::OnRep_CurrentIndex(int32 OldIndex)
-{
-	BroadcastChanged(GetEquipmentAt(CurrentIndex), GetEquipmentAt(OldIndex));
+		OnEquipmentAdded.Broadcast(Equipment, SlotIndex);
+	}
 }
 
-void UGE_EquipmentManagerComponent::ServerEquipSlot_Implementation(int32 SlotIndex)
+void UGE_EquipmentManagerComponent::HandleSlotRemoved(int32 SlotIndex)
 {
-	BeginServerSwap(SlotIndex);
-}
+	if (!Slots.IsValidIndex(SlotIndex) || !Slots[SlotIndex]) return;
 
-void UGE_EquipmentManagerComponent::ServerCycle_Implementation(int32 Delta)
-{
-	const int32 To = FindNextIndex(Delta);
+	AGE_Equipment* Old = Slots[SlotIndex];
+	Slots[SlotIndex] = nullptr;
 
-	if (To != INDEX_NONE)
-	{
-		BeginServerSwap(To);
-	}
+	OnEquipmentRemoved.Broadcast(Old, SlotIndex);
 }
 
-void UGE_EquipmentManagerComponent::MulticastBeginUnequip_Implementation(int32 FromIndex)
+void UGE_EquipmentManagerComponent::OnRep_CurrentIndex(int32 OldIndex)
 {
-	Local_BeginUnequip(FromIndex, INDEX_NONE);
+	BroadcastChanged(GetEquipmentAt(CurrentIndex), GetEquipmentAt(OldIndex));
 }
 
-void UGE_EquipmentManagerComponent::MulticastBeginEquip_Implementation(int32 ToIndex)
+void UGE_EquipmentManagerComponent::OnRep_FlowState()
 {
-	const int32 Old = CurrentIndex;
-	CurrentIndex = ToIndex;
-
-	if (Old != ToIndex)
+	if (IsPredictingFlow())
 	{
-		BroadcastChanged(GetEquipmentAt(ToIndex), GetEquipmentAt(Old));
+		// Our prediction stands until the server has seen our latest request
+		if (FlowState.RequestId != LocalRequestId) return;
+
+		// Still heading where we already are, the server is only behind in time
+		if (FlowState.ToIndex == GetPredictedTarget()) return;
 	}
 
-	Local_BeginEquip(ToIndex);
+	Local_ApplyFlowState();
 }
 
-void UGE_EquipmentManagerComponent::MulticastCancelUnequip_Implementation(int32 Index)
+void UGE_EquipmentManagerComponent::ServerEquipSlot_Implementation(int32 SlotIndex, uint8 RequestId)
 {
-	Local_CancelUnequip(Index);
+	// Acked even when ignored, so the owner can settle its prediction
+	FlowState.RequestId = RequestId;
+
+	if (!Slots.IsValidIndex(SlotIndex) || !Slots[SlotIndex]) return;
+
+	BeginServerSwap(SlotIndex);
 }
@@ -1,11 +1,16 @@
 #include "Equipments/GE_Equipment.h"
 
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 #include "Misc/GE_EquipmentAnimData.h"
+#include "Misc/GE_Stats.h"
+#include "Subsystems/GE_EquipmentPoolSubsystem.h"
 #include "Interfaces/GE_CharacterInterface.h"
 #include "GameFramework/Character.h"
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dehydrated Equipment"), STAT_GE_DehydratedEquipment, STATGROUP_GameplayEquipments);
+
 AGE_Equipment::AGE_Equipment(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -25,6 +30,7 @@ AGE_Equipment::AGE_Equipment(const FObjectInitializer& ObjectInitializer)
 	MeshTP->SetOwnerNoSee(true);
 
 	bOwnerIsFirstPerson = true;
+	bDehydrated = false;
 
 	bReplicates = true;
 	bAlwaysRelevant = true;
@@ -49,8 +55,11 @@ void AGE_Equipment::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLif
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AGE_Equipment, EquipState);
-	DOREPLIFETIME(AGE_Equipment, bEquipped);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AGE_Equipment, EquipState, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AGE_Equipment, bEquipped, Params);
 }
 
 void AGE_Equipment::PreInitializeComponents()
@@ -72,6 +81,19 @@ void AGE_Equipment::BeginPlay()
 
 void AGE_Equipment::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	if (bDehydrated)
+	{
+		DEC_DWORD_STAT(STAT_GE_DehydratedEquipment);
+	}
+
+	if (EndPlayReason == EEndPlayReason::Destroyed && HasAuthority())
+	{
+		if (UGE_EquipmentPoolSubsystem* Pool = GetWorld()->GetSubsystem<UGE_EquipmentPoolSubsystem>())
+		{
+			Pool->NotifyEquipmentDestroyed(this);
+		}
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -213,9 +235,11 @@ void AGE_Equipment::StopEquipmentMontageSet(const FEquipmentAnimMontageData& Dat
 float AGE_Equipment::BeginEquip(bool bFirstPerson, bool bThirdPerson)
 {
 	EquipState = EGE_EquipmentState::Equipping;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
 	OnRep_EquipState();
 
 	bEquipped = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, bEquipped, this);
 	OnRep_Equipped();
 
 	return AnimData ? PlayEquipmentMontageSet(AnimData->EquipAnim, bFirstPerson, bThirdPerson) : 0.f;
@@ -224,15 +248,18 @@ float AGE_Equipment::BeginEquip(bool bFirstPerson, bool bThirdPerson)
 void AGE_Equipment::EndEquip()
 {
 	EquipState = EGE_EquipmentState::Equipped;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
 	OnRep_EquipState();
 
 	bEquipped = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, bEquipped, this);
 	OnRep_Equipped();
 }
 
 float AGE_Equipment::BeginUnequip(bool bFirstPerson, bool bThirdPerson)
 {
 	EquipState = EGE_EquipmentState::Unequipping;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
 	OnRep_EquipState();
 
 	return AnimData ? PlayEquipmentMontageSet(AnimData->UnEquipAnim, bFirstPerson, bThirdPerson) : 0.f;
@@ -241,9 +268,11 @@ float AGE_Equipment::BeginUnequip(bool bFirstPerson, bool bThirdPerson)
 void AGE_Equipment::EndUnequip()
 {
 	EquipState = EGE_EquipmentState::Idle;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
 	OnRep_EquipState();
 
 	bEquipped = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, bEquipped, this);
 	OnRep_Equipped();
 
 	if (AnimData)
@@ -255,9 +284,11 @@ void AGE_Equipment::EndUnequip()
 void AGE_Equipment::ForceEquippedVisible(bool bFirstPerson)
 {
 	EquipState = EGE_EquipmentState::Equipped;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
 	OnRep_EquipState();
 
 	bEquipped = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, bEquipped, this);
 	OnRep_Equipped();
 }
 
@@ -271,9 +302,11 @@ void AGE_Equipment::CancelUnequip()
 	}
 
 	EquipState = EGE_EquipmentState::Equipped;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
 	OnRep_EquipState();
 
 	bEquipped = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, bEquipped, this);
 	OnRep_Equipped();
 }
 
@@ -300,6 +333,8 @@ void AGE_Equipment::AttachToHolders()
 
 void AGE_Equipment::DetachFromHolders()
 {
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+
 	MeshFP->SetRelativeTransform_Direct(FTransform::Identity);
 	MeshTP->SetRelativeTransform_Direct(FTransform::Identity);
 	MeshFP->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
@@ -311,10 +346,53 @@ void AGE_Equipment::DetachFromHolders()
 void AGE_Equipment::UpdateTickAndVisibility()
 {
 	const bool bActive = (EquipState != EGE_EquipmentState::Idle);
+	SetDehydrated(!bActive);
 	SetActorTickEnabled(bActive);
 	SetActorHiddenInGame(!bActive);
 }
 
+void AGE_Equipment::SetDehydrated(bool bNewDehydrated)
+{
+	if (bDehydrated == bNewDehydrated) return;
+
+	bDehydrated = bNewDehydrated;
+
+	for (USkeletalMeshComponent* Mesh : { MeshFP.Get(), MeshTP.Get() })
+	{
+		if (bNewDehydrated)
+		{
+			Mesh->UnregisterComponent();
+		}
+		else if (!Mesh->IsRegistered())
+		{
+			Mesh->RegisterComponent();
+		}
+	}
+
+	// Only the server decides dormancy, the final Idle state still goes out before the channel closes
+	if (HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		SetNetDormancy(bNewDehydrated ? DORM_DormantAll : DORM_Awake);
+	}
+
+	if (bNewDehydrated)
+	{
+		INC_DWORD_STAT(STAT_GE_DehydratedEquipment);
+	}
+	else
+	{
+		DEC_DWORD_STAT(STAT_GE_DehydratedEquipment);
+	}
+}
+
+void AGE_Equipment::FlushDehydratedState()
+{
+	if (bDehydrated && HasAuthority())
+	{
+		FlushNetDormancy();
+	}
+}
+
 void AGE_Equipment::OnRep_EquipState()
 {
 	UpdateTickAndVisibility();
@@ -339,6 +417,24 @@ void AGE_Equipment::SetOwningCharacter(ACharacter* NewOwner)
 
 	if (IsValid(NewOwner)) { AttachToHolders(); }
 	else { DetachFromHolders(); }
+
+	// Pooled equipment changes hands while dormant
+	FlushDehydratedState();
+}
+
+void AGE_Equipment::ResetForPool()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	EquipState = EGE_EquipmentState::Idle;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, EquipState, this);
+
+	bEquipped = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_Equipment, bEquipped, this);
+
+	UpdateTickAndVisibility();
+
+	SetOwningCharacter(nullptr);
 }
 
 void AGE_Equipment::UpdateViewMode(bool bFirstPerson)
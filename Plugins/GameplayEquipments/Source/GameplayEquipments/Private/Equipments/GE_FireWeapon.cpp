@@ -1,6 +1,7 @@
 #include "Equipments/GE_FireWeapon.h"
 
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/DamageType.h"
@@ -11,9 +12,19 @@
 #include "Components/InputComponent.h"
 #include "Sound/SoundBase.h"
 #include "PhysicsEngine/PhysicsSettings.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "HAL/IConsoleManager.h"
 
 #include "Misc/GE_EquipmentAnimData.h"
+#include "Misc/GE_Stats.h"
+#include "Misc/GE_PenetrationData.h"
+#include "Misc/GE_DamageProfileData.h"
 #include "Interfaces/GE_CharacterInterface.h"
+#include "Subsystems/GE_LagCompensationSubsystem.h"
+#include "Subsystems/GE_HitscanSubsystem.h"
+#include "Subsystems/GE_ProjectileSubsystem.h"
+#include "Subsystems/GE_ImpactFXSubsystem.h"
 
 #define LOCTEXT_NAMESPACE "GE_FireWeapon"
 
@@ -22,22 +33,493 @@ static float GE_FireIntervalFromRPM(float RPM)
 	return RPM <= 0.f ? 0.1f : 60.f / RPM;
 }
 
+static bool GE_IsSequenceNewer(uint16 A, uint16 B)
+{
+	return static_cast<int16>(A - B) > 0;
+}
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Command Bytes"), STAT_GE_WeaponCommandBytes, STATGROUP_GameplayEquipments);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Weapon Command Bandwidth (B/s)"), STAT_GE_WeaponCommandBandwidth, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Command Overflows"), STAT_GE_WeaponCommandOverflows, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Mispredictions"), STAT_GE_WeaponMispredictions, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot Damage Events"), STAT_GE_ShotDamageEvents, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot Damage Pellets"), STAT_GE_ShotDamagePellets, STATGROUP_GameplayEquipments);
+
+static TAutoConsoleVariable<float> CVarWeaponCommandResendInterval(
+	TEXT("GE.WeaponCommands.ResendInterval"),
+	0.03f,
+	TEXT("Seconds between resends of unacknowledged weapon commands."),
+	ECVF_Default);
+
+#if STATS
+static void GE_RecordCommandBytes(int32 NumBytes)
+{
+	static double WindowStart = FPlatformTime::Seconds();
+	static int32 WindowBytes = 0;
+
+	INC_DWORD_STAT_BY(STAT_GE_WeaponCommandBytes, NumBytes);
+	WindowBytes += NumBytes;
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - WindowStart >= 1.0)
+	{
+		SET_FLOAT_STAT(STAT_GE_WeaponCommandBandwidth, static_cast<float>(WindowBytes / (Now - WindowStart)));
+		WindowStart = Now;
+		WindowBytes = 0;
+	}
+}
+#endif
+
+// FGE_BulletData
+
+bool FGE_BulletData::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	StartLocation.NetSerialize(Ar, Map, bOutSuccess);
+	AimRotation.SerializeCompressedShort(Ar);
+
+	uint16 PackedSpread = 0;
+	if (Ar.IsSaving())
+	{
+		PackedSpread = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Spread * 100.f), 0, MAX_uint16));
+	}
+	Ar << PackedSpread;
+	Ar << ShotSequence;
+
+	if (Ar.IsLoading())
+	{
+		Spread = PackedSpread * 0.01f;
+
+		Directions.Reset();
+		EndLocations.Reset();
+	}
+
+	return true;
+}
+
+void FGE_BulletData::Quantize()
+{
+	FBitWriter Writer(0, true);
+	bool bSuccess;
+	NetSerialize(Writer, nullptr, bSuccess);
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	NetSerialize(Reader, nullptr, bSuccess);
+}
+
+void FGE_BulletData::GenerateDirections(int32 NumPellets, float TraceDist)
+{
+	TArray<FVector> Pellets;
+	GeneratePelletDirections(AimRotation, Spread, ShotSequence, NumPellets, Pellets);
+
+	Directions.Reset(Pellets.Num());
+	EndLocations.Reset(Pellets.Num());
+
+	for (const FVector& Dir : Pellets)
+	{
+		Directions.Add(Dir);
+		EndLocations.Add(StartLocation + Dir * TraceDist);
+	}
+}
+
+void FGE_BulletData::GeneratePelletDirections(const FRotator& Aim, float Spread, uint16 ShotSequence, int32 NumPellets, TArray<FVector>& OutDirections)
+{
+	// Integer stream, identical sequence on every platform and build configuration
+	FRandomStream Stream(static_cast<int32>(static_cast<uint32>(ShotSequence) * 2654435761u));
+
+	FRotator Rot = Aim;
+	for (int32 i = 0; i < NumPellets; ++i)
+	{
+		if (Spread > 0.f)
+		{
+			const FRotator RandRot(Stream.FRandRange(-Spread, Spread), Stream.FRandRange(-Spread, Spread), Stream.FRandRange(-Spread, Spread));
+			Rot += RandRot;
+		}
+
+		OutDirections.Add(Rot.GetNormalized().Vector());
+	}
+}
+
+// FGE_WeaponCommand
+
+bool FGE_WeaponCommand::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	uint8 PackedType = static_cast<uint8>(Type);
+	Ar.SerializeBits(&PackedType, 3);
+	Type = static_cast<EGE_WeaponCommandType>(PackedType);
+
+	switch (Type)
+	{
+		case EGE_WeaponCommandType::SetFiring:
+		case EGE_WeaponCommandType::SetAiming:
+		case EGE_WeaponCommandType::CommitReload:
+		{
+			Ar.SerializeBits(&Param, 1);
+			break;
+		}
+		case EGE_WeaponCommandType::SetFireMode:
+		{
+			Ar.SerializeBits(&Param, 2);
+			break;
+		}
+		case EGE_WeaponCommandType::Fire:
+		{
+			Shot.NetSerialize(Ar, Map, bOutSuccess);
+			break;
+		}
+		default:
+			break;
+	}
+
+	return bOutSuccess;
+}
+
+// FGE_WeaponCommandPacket
+
+bool FGE_WeaponCommandPacket::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	uint8 NumCommands = static_cast<uint8>(FMath::Min(Commands.Num(), MaxCommands));
+	Ar.SerializeBits(&NumCommands, 6);
+
+	// Sequences are consecutive, only the first one is sent
+	uint16 FirstSequence = Commands.Num() > 0 ? Commands[0].Sequence : 0;
+	if (NumCommands > 0)
+	{
+		Ar << FirstSequence;
+	}
+
+	if (Ar.IsLoading())
+	{
+		if (NumCommands > MaxCommands)
+		{
+			bOutSuccess = false;
+			return false;
+		}
+		Commands.SetNum(NumCommands);
+	}
+
+	// The first timed shot is the base, the rest of a packet spans well under the 32 seconds an offset covers
+	double BaseTime = -1.0;
+	for (int32 i = 0; i < NumCommands && Ar.IsSaving(); ++i)
+	{
+		if (Commands[i].Type == EGE_WeaponCommandType::Fire && Commands[i].FireTime >= 0.0)
+		{
+			BaseTime = Commands[i].FireTime;
+			break;
+		}
+	}
+
+	uint8 bHasBaseTime = BaseTime >= 0.0 ? 1 : 0;
+	Ar.SerializeBits(&bHasBaseTime, 1);
+	if (bHasBaseTime)
+	{
+		Ar << BaseTime;
+	}
+
+	for (int32 i = 0; i < NumCommands && bOutSuccess; ++i)
+	{
+		FGE_WeaponCommand& Command = Commands[i];
+		Command.Sequence = static_cast<uint16>(FirstSequence + i);
+		Command.NetSerialize(Ar, Map, bOutSuccess);
+
+		if (Command.Type != EGE_WeaponCommandType::Fire) continue;
+
+		uint8 bHasFireTime = bHasBaseTime && Command.FireTime >= 0.0 ? 1 : 0;
+		if (bHasBaseTime)
+		{
+			Ar.SerializeBits(&bHasFireTime, 1);
+		}
+
+		int16 OffsetMs = bHasFireTime ? static_cast<int16>(FMath::Clamp<int64>(FMath::RoundToInt64((Command.FireTime - BaseTime) * 1000.0), MIN_int16, MAX_int16)) : 0;
+		if (bHasFireTime)
+		{
+			Ar << OffsetMs;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Command.FireTime = bHasFireTime ? BaseTime + OffsetMs * 0.001 : -1.0;
+		}
+	}
+
+	return bOutSuccess && !Ar.IsError();
+}
+
+// FGE_WeaponNetState
+
+namespace GE_WeaponNetGroup
+{
+	static constexpr uint8 Ammo    = 1 << 0;
+	static constexpr uint8 Reserve = 1 << 1;
+	static constexpr uint8 Flags   = 1 << 2;
+	static constexpr uint8 Bullet  = 1 << 3;
+	static constexpr uint32 NumBits = 4;
+}
+
+/** What a connection last acknowledged, the next update only carries the groups that differ from it. */
+class FGE_WeaponNetDeltaState : public INetDeltaBaseState
+{
+public:
+	int32 AmmoInMag = 0;
+	int32 TotalAmmo = 0;
+	uint8 Flags = 0;
+	uint16 ShotSequence = 0;
+
+	virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+	{
+		const FGE_WeaponNetDeltaState* Other = static_cast<const FGE_WeaponNetDeltaState*>(OtherState);
+		return AmmoInMag == Other->AmmoInMag && TotalAmmo == Other->TotalAmmo && Flags == Other->Flags && ShotSequence == Other->ShotSequence;
+	}
+};
+
+uint8 FGE_WeaponNetState::PackFlags() const
+{
+	return static_cast<uint8>((bIsFiring ? 1 : 0) | (bIsReloading ? 2 : 0) | (bIsAiming ? 4 : 0) | (static_cast<uint8>(FireMode) << 3));
+}
+
+void FGE_WeaponNetState::UnpackFlags(uint8 Packed)
+{
+	bIsFiring = (Packed & 1) != 0;
+	bIsReloading = (Packed & 2) != 0;
+	bIsAiming = (Packed & 4) != 0;
+	FireMode = static_cast<EGEFireMode>(FMath::Min<uint8>((Packed >> 3) & 3, static_cast<uint8>(EGEFireMode::Auto)));
+}
+
+bool FGE_WeaponNetState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	if (DeltaParms.Writer)
+	{
+		FBitWriter& Ar = *DeltaParms.Writer;
+		const FGE_WeaponNetDeltaState* OldState = static_cast<const FGE_WeaponNetDeltaState*>(DeltaParms.OldState);
+
+		TSharedPtr<FGE_WeaponNetDeltaState> NewState = MakeShared<FGE_WeaponNetDeltaState>();
+		NewState->AmmoInMag = FMath::Clamp(AmmoInMag, 0, MaxAmmoInMag);
+		NewState->TotalAmmo = FMath::Max(0, TotalAmmo);
+		NewState->Flags = PackFlags();
+		NewState->ShotSequence = BulletData.ShotSequence;
+
+		// A new or reopened channel gets every state group, the client's spawn defaults need not match anything.
+		// A shot is an event, late joiners don't replay the last one
+		uint8 Groups = GE_WeaponNetGroup::Ammo | GE_WeaponNetGroup::Reserve | GE_WeaponNetGroup::Flags;
+		if (OldState)
+		{
+			Groups = 0;
+			if (NewState->AmmoInMag != OldState->AmmoInMag) { Groups |= GE_WeaponNetGroup::Ammo; }
+			if (NewState->TotalAmmo != OldState->TotalAmmo) { Groups |= GE_WeaponNetGroup::Reserve; }
+			if (NewState->Flags != OldState->Flags) { Groups |= GE_WeaponNetGroup::Flags; }
+			if (NewState->ShotSequence != OldState->ShotSequence) { Groups |= GE_WeaponNetGroup::Bullet; }
+		}
+
+		if (Groups == 0 && OldState)
+		{
+			return false;
+		}
+
+		*DeltaParms.NewState = NewState;
+
+		Ar.SerializeBits(&Groups, GE_WeaponNetGroup::NumBits);
+
+		if (Groups & GE_WeaponNetGroup::Ammo)
+		{
+			uint32 Value = static_cast<uint32>(NewState->AmmoInMag);
+			Ar.SerializeInt(Value, static_cast<uint32>(MaxAmmoInMag) + 1);
+		}
+		if (Groups & GE_WeaponNetGroup::Reserve)
+		{
+			uint32 Value = static_cast<uint32>(NewState->TotalAmmo);
+			Ar.SerializeIntPacked(Value);
+		}
+		if (Groups & GE_WeaponNetGroup::Flags)
+		{
+			uint8 Packed = NewState->Flags;
+			Ar.SerializeBits(&Packed, 5);
+		}
+		if (Groups & GE_WeaponNetGroup::Bullet)
+		{
+			bool bSuccess;
+			BulletData.NetSerialize(Ar, DeltaParms.Map, bSuccess);
+		}
+
+		return true;
+	}
+
+	if (DeltaParms.Reader)
+	{
+		FBitReader& Ar = *DeltaParms.Reader;
+
+		uint8 Groups = 0;
+		Ar.SerializeBits(&Groups, GE_WeaponNetGroup::NumBits);
+
+		ChangedFields = EGE_WeaponStateField::None;
+		PreviousTotalAmmo = TotalAmmo;
+
+		if (Groups & GE_WeaponNetGroup::Ammo)
+		{
+			uint32 Value = 0;
+			Ar.SerializeInt(Value, static_cast<uint32>(MaxAmmoInMag) + 1);
+			if (AmmoInMag != static_cast<int32>(Value)) { ChangedFields |= EGE_WeaponStateField::AmmoInMag; }
+			AmmoInMag = static_cast<int32>(Value);
+		}
+		if (Groups & GE_WeaponNetGroup::Reserve)
+		{
+			uint32 Value = 0;
+			Ar.SerializeIntPacked(Value);
+			if (TotalAmmo != static_cast<int32>(Value)) { ChangedFields |= EGE_WeaponStateField::TotalAmmo; }
+			TotalAmmo = static_cast<int32>(Value);
+		}
+		if (Groups & GE_WeaponNetGroup::Flags)
+		{
+			uint8 Packed = 0;
+			Ar.SerializeBits(&Packed, 5);
+
+			const bool bOldFiring = bIsFiring;
+			const bool bOldReloading = bIsReloading;
+			const bool bOldAiming = bIsAiming;
+			const EGEFireMode OldFireMode = FireMode;
+			UnpackFlags(Packed);
+
+			if (bSkipOwnerFields)
+			{
+				bIsFiring = bOldFiring;
+				bIsAiming = bOldAiming;
+			}
+
+			if (bIsFiring != bOldFiring) { ChangedFields |= EGE_WeaponStateField::Firing; }
+			if (bIsReloading != bOldReloading) { ChangedFields |= EGE_WeaponStateField::Reloading; }
+			if (bIsAiming != bOldAiming) { ChangedFields |= EGE_WeaponStateField::Aiming; }
+			if (FireMode != OldFireMode) { ChangedFields |= EGE_WeaponStateField::FireMode; }
+		}
+		if (Groups & GE_WeaponNetGroup::Bullet)
+		{
+			// Still read to keep the stream aligned when the owner drops it
+			FGE_BulletData ReceivedShot;
+			bool bSuccess;
+			ReceivedShot.NetSerialize(Ar, DeltaParms.Map, bSuccess);
+
+			if (!bSkipOwnerFields)
+			{
+				BulletData = MoveTemp(ReceivedShot);
+				ChangedFields |= EGE_WeaponStateField::Bullet;
+			}
+		}
+
+		return !Ar.IsError();
+	}
+
+	return false;
+}
+
+// Prints a hash of regenerated pellets. Run on a client and a server build, the hashes must match.
+static void GE_SpreadDeterminism(const TArray<FString>& Args)
+{
+	const int32 NumShots = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4096;
+	const int32 NumPellets = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 12;
+
+	uint32 Hash = 0;
+	int32 NumMismatches = 0;
+
+	for (int32 i = 0; i < NumShots; ++i)
+	{
+		const float Alpha = static_cast<float>(i) / FMath::Max(1, NumShots);
+
+		FGE_BulletData Sent(FVector(1234.567 * Alpha, -8910.11, 120.25), FRotator(-30.f + 60.f * Alpha, 360.f * Alpha, 0.f), 6.f * Alpha, static_cast<uint16>(i));
+		Sent.Quantize();
+		Sent.GenerateDirections(NumPellets, 20000.f);
+
+		FBitWriter Writer(0, true);
+		bool bSuccess;
+		Sent.NetSerialize(Writer, nullptr, bSuccess);
+
+		FGE_BulletData Received;
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		Received.NetSerialize(Reader, nullptr, bSuccess);
+		Received.GenerateDirections(NumPellets, 20000.f);
+
+		for (int32 p = 0; p < NumPellets; ++p)
+		{
+			if (FMemory::Memcmp(&Sent.Directions[p], &Received.Directions[p], sizeof(FVector)) != 0)
+			{
+				++NumMismatches;
+			}
+			Hash = FCrc::MemCrc32(&Received.Directions[p], sizeof(FVector), Hash);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Spread determinism: %d shots x %d pellets, %d mismatches, hash %08x"), NumShots, NumPellets, NumMismatches, Hash);
+}
+
+static FAutoConsoleCommand CmdSpreadDeterminism(
+	TEXT("GE.Spread.Determinism"),
+	TEXT("Regenerates pellets through a serialize round trip and prints a hash to compare across builds.\nArgs: [NumShots=4096] [NumPellets=12]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&GE_SpreadDeterminism));
+
+// Round trips a packet of fire commands as a burst left unacked would resend it, and reports its size and fire time error
+static void GE_WeaponCommandSize(const TArray<FString>& Args)
+{
+	const int32 NumCommands = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 8, 1, FGE_WeaponCommandPacket::MaxCommands);
+	const double Interval = GE_FireIntervalFromRPM(Args.Num() > 1 ? FCString::Atof(*Args[1]) : 600.f);
+
+	FGE_WeaponCommandPacket Sent;
+	for (int32 i = 0; i < NumCommands; ++i)
+	{
+		FGE_WeaponCommand& Command = Sent.Commands.Add_GetRef(FGE_WeaponCommand(EGE_WeaponCommandType::Fire));
+		Command.Sequence = static_cast<uint16>(100 + i);
+		Command.Shot = FGE_BulletData(FVector(1234.5, -678.9, 150.0), FRotator(-2.f, 45.f + i, 0.f), 1.5f, static_cast<uint16>(i));
+		Command.FireTime = 3600.0 + i * Interval + FMath::Frac(i * 0.37) * 0.001;
+	}
+
+	FBitWriter Writer(0, true);
+	bool bSuccess;
+	Sent.NetSerialize(Writer, nullptr, bSuccess);
+
+	FGE_WeaponCommandPacket Received;
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	Received.NetSerialize(Reader, nullptr, bSuccess);
+
+	double MaxError = 0.0;
+	for (int32 i = 0; i < FMath::Min(Sent.Commands.Num(), Received.Commands.Num()); ++i)
+	{
+		MaxError = FMath::Max(MaxError, FMath::Abs(Sent.Commands[i].FireTime - Received.Commands[i].FireTime));
+	}
+
+	// A full double per command, less the base time and the flag and offset each command now sends
+	const int64 NewBits = Writer.GetNumBits();
+	const int64 OldBits = NewBits - (1 + 64 + NumCommands * 17) + NumCommands * 64;
+
+	UE_LOG(LogTemp, Display, TEXT("Weapon command packet: %d fire commands, %lld bytes, was %lld with full fire times. Max fire time error %.3f ms, %s"),
+		NumCommands, (NewBits + 7) / 8, (OldBits + 7) / 8, MaxError * 1000.0, bSuccess && Received.Commands.Num() == NumCommands ? TEXT("decoded") : TEXT("FAILED to decode"));
+}
+
+static FAutoConsoleCommand CmdWeaponCommandSize(
+	TEXT("GE.WeaponCommands.Size"),
+	TEXT("Round trips a packet of unacked fire commands and reports its size against full 64 bit fire times.\nArgs: [NumCommands=8] [RPM=600]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&GE_WeaponCommandSize));
+
 AGE_FireWeapon::AGE_FireWeapon(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	AmmoInMag = 0;
-	TotalAmmo = InitialTotalAmmo;
+	NetState.AmmoInMag = 0;
+	NetState.TotalAmmo = InitialTotalAmmo;
 
 	BurstLeft = 0;
 	bBurstSequencing = false;
 	bRunFireDelayActive = false;
 	bWantsToFireInput = false;
+	bCommandFlushPending = false;
+	bHasConfirmedState = false;
+	bReceivingState = false;
+	bStateReconciled = false;
 
 	ReloadKeys = { EKeys::R };
 	FireModeKeys = { EKeys::B };
 	bBindedInputs = false;
 
-	RepFireMode = FireMode;
+	NetState.FireMode = FireMode;
 }
 
 #if WITH_EDITOR
@@ -53,7 +535,7 @@ void AGE_FireWeapon::PostEditChangeProperty(FPropertyChangedEvent& PropertyChang
 	if (PropertyChangedEvent.Property &&
 		PropertyChangedEvent.Property->GetFName() == GET_MEMBER_NAME_CHECKED(AGE_FireWeapon, FireMode))
 	{
-		RepFireMode = FireMode;
+		NetState.FireMode = FireMode;
 	}
 }
 #endif
@@ -62,14 +544,13 @@ void AGE_FireWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AGE_FireWeapon, AmmoInMag);
-	DOREPLIFETIME(AGE_FireWeapon, TotalAmmo);
-	DOREPLIFETIME(AGE_FireWeapon, bIsReloading);
-	DOREPLIFETIME(AGE_FireWeapon, RepFireMode);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AGE_FireWeapon, NetState, Params);
 
-	DOREPLIFETIME_CONDITION(AGE_FireWeapon, bIsFiring, COND_SkipOwner);
-	DOREPLIFETIME_CONDITION(AGE_FireWeapon, BulletData, COND_SkipOwner);
-	DOREPLIFETIME_CONDITION(AGE_FireWeapon, bIsAiming, COND_SkipOwner);
+	Params.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AGE_FireWeapon, AckedCommandSequence, Params);
 }
 
 void AGE_FireWeapon::PreInitializeComponents()
@@ -80,6 +561,9 @@ void AGE_FireWeapon::PreInitializeComponents()
 void AGE_FireWeapon::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
+
+	// Before the first replicated update arrives, and never from a runtime-modified capacity
+	NetState.MaxAmmoInMag = FMath::Max(1, GetClass()->GetDefaultObject<AGE_FireWeapon>()->MagazineCapacity);
 }
 
 void AGE_FireWeapon::BeginPlay()
@@ -91,10 +575,18 @@ void AGE_FireWeapon::BeginPlay()
 
 	if (HasAuthority())
 	{
-		AmmoInMag = FMath::Clamp(MagazineCapacity, 0, MagazineCapacity);
-		TotalAmmo = FMath::Max(0, InitialTotalAmmo);
+		NetState.AmmoInMag = FMath::Clamp(MagazineCapacity, 0, MagazineCapacity);
+		NetState.TotalAmmo = FMath::Max(0, InitialTotalAmmo);
+		NetState.FireMode = FireMode;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AGE_FireWeapon, NetState, this);
+	}
 
-		RepFireMode = FireMode;
+	if (ImpactFXData)
+	{
+		if (UGE_ImpactFXSubsystem* ImpactFX = GetWorld()->GetSubsystem<UGE_ImpactFXSubsystem>())
+		{
+			ImpactFX->Prewarm(ImpactFXData);
+		}
 	}
 
 	if (ACharacter* C = Cast<ACharacter>(GetOwner()))
@@ -125,12 +617,20 @@ void AGE_FireWeapon::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	RefreshFireSchedule();
 	RefreshAimingTimeline(DeltaTime);
 }
 
 void AGE_FireWeapon::OnRep_Owner()
 {
+	const bool bOwnerChanged = OwningCharacter.Get() != GetOwner();
+
 	Super::OnRep_Owner();
+
+	if (bOwnerChanged)
+	{
+		ResetCommandStream();
+	}
 	
 	if (ACharacter* C = Cast<ACharacter>(GetOwner()))
 	{
@@ -148,10 +648,87 @@ void AGE_FireWeapon::SetActorHiddenInGame(bool bNewHidden)
 	Super::SetActorHiddenInGame(bNewHidden);
 }
 
+void AGE_FireWeapon::PreNetReceive()
+{
+	Super::PreNetReceive();
+
+	bStateReconciled = false;
+
+	if (IsPredictingState() && bHasConfirmedState)
+	{
+		// Receive on top of the last server state, the prediction is replayed in PostNetReceive
+		DisplayedState = CaptureState();
+		ReceiveAckedCommandSequence = AckedCommandSequence;
+		bReceivingState = true;
+		RestoreState(ConfirmedState);
+	}
+}
+
+void AGE_FireWeapon::PostNetReceive()
+{
+	Super::PostNetReceive();
+
+	if (!bReceivingState)
+	{
+		if (IsPredictingState())
+		{
+			ConfirmedState = CaptureState();
+			bHasConfirmedState = true;
+		}
+		return;
+	}
+
+	bReceivingState = false;
+
+	const FGE_WeaponPredictedState PreviousConfirmedState = ConfirmedState;
+	ConfirmedState = CaptureState();
+
+	if (AckedCommandSequence != ReceiveAckedCommandSequence)
+	{
+		int32 NumAcked = 0;
+		for (; NumAcked < PredictionHistory.Num(); ++NumAcked)
+		{
+			const FGE_WeaponPrediction& Prediction = PredictionHistory[NumAcked];
+			if (GE_IsSequenceNewer(Prediction.CommandSequence, AckedCommandSequence)) break;
+
+			if (Prediction.CommandSequence == AckedCommandSequence && Prediction.State != ConfirmedState)
+			{
+				INC_DWORD_STAT(STAT_GE_WeaponMispredictions);
+				UE_LOG(LogTemp, Verbose, TEXT("%s mispredicted shot %d: ammo %d/%d, server %d/%d"), *GetName(), Prediction.ShotSequence,
+					Prediction.State.AmmoInMag, Prediction.State.TotalAmmo, ConfirmedState.AmmoInMag, ConfirmedState.TotalAmmo);
+			}
+		}
+
+		PredictionHistory.RemoveAt(0, NumAcked, EAllowShrinking::No);
+	}
+
+	// The ack usually lands with the state it produced and its RepNotify runs after this, so skip what it already covers
+	FGE_WeaponPredictedState PredictedState = ConfirmedState;
+	for (const FGE_WeaponCommand& Command : UnackedCommands.Commands)
+	{
+		if (GE_IsSequenceNewer(Command.Sequence, AckedCommandSequence))
+		{
+			SimulateCommand(PredictedState, Command);
+		}
+	}
+
+	// Events fire against what the player was shown, not the intermediate server values
+	RestoreState(DisplayedState);
+	ApplyPredictedState(PredictedState);
+	bStateReconciled = true;
+
+	if (ConfirmedState.TotalAmmo > PreviousConfirmedState.TotalAmmo)
+	{
+		UGameplayStatics::SpawnSoundAtLocation(this, AmmoPickupSound, GetActorLocation());
+	}
+}
+
 void AGE_FireWeapon::SetOwningCharacter(ACharacter* NewOwner)
 {
 	Super::SetOwningCharacter(NewOwner);
 
+	NetState.bSkipOwnerFields = IsValid(NewOwner) && IsPredictingState();
+
 	if (IsValid(NewOwner))
 	{
 		if (IsLocallyControlled() && !bBindedInputs)
@@ -203,6 +780,41 @@ void AGE_FireWeapon::OnBeforeRemoved(UGE_EquipmentManagerComponent* Manager, EGE
 	// #TODO
 }
 
+void AGE_FireWeapon::ResetForPool()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	FireScheduler.Stop();
+
+	BurstLeft = 0;
+	bBurstSequencing = false;
+	bRunFireDelayActive = false;
+	bWantsToFireInput = false;
+
+	Imprecision = MaxImprecision;
+	BulletFired = 0;
+	LastShotTime = -1.0;
+
+	AimHoldTime = 0.f;
+	FOVPlayback = ADSPlayback = 0.f;
+	FOVAlpha = ADSAlpha = 0.f;
+
+	FireMode = GetClass()->GetDefaultObject<AGE_FireWeapon>()->FireMode;
+
+	NetState.AmmoInMag = FMath::Clamp(MagazineCapacity, 0, MagazineCapacity);
+	NetState.TotalAmmo = FMath::Max(0, InitialTotalAmmo);
+	NetState.bIsFiring = false;
+	NetState.bIsReloading = false;
+	NetState.bIsAiming = false;
+	NetState.FireMode = FireMode;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_FireWeapon, NetState, this);
+
+	ResetCommandStream();
+	PendingShotDamage.Reset();
+
+	// Drops the input bindings with the owner
+	Super::ResetForPool();
+}
+
 float AGE_FireWeapon::BeginEquip(bool bFirstPerson, bool bThirdPerson)
 {
 	return Super::BeginEquip(bFirstPerson, bThirdPerson);
@@ -225,7 +837,7 @@ float AGE_FireWeapon::BeginUnequip(bool bFirstPerson, bool bThirdPerson)
 
 bool AGE_FireWeapon::CanRun() const
 {
-	if (IsAiming() || bIsFiring || bRunFireDelayActive)
+	if (IsAiming() || NetState.bIsFiring || bRunFireDelayActive)
 	{
 		return false;
 	}
@@ -258,15 +870,15 @@ void AGE_FireWeapon::StartReload()
 
 	if (HasAuthority())
 	{
-		if (!bIsReloading)
+		if (!NetState.bIsReloading)
 		{
-			bIsReloading = true;
-			OnRep_IsReloading();
+			NetState.bIsReloading = true;
+			CommitState(EGE_WeaponStateField::Reloading);
 		}
 	}
 	else
 	{
-		ServerRequestStartReload();
+		SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::StartReload));
 	}
 }
 
@@ -276,7 +888,7 @@ void AGE_FireWeapon::Notify_InsertOneRound()
 
 	if (IsLocallyControlled())
 	{
-		ServerInsertOneRound();
+		SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::InsertRound));
 
 		PlayEquipmentMontageSet(ReloadAnim, /*FP*/true, /*TP*/true, /*PlayRate*/1.0f, ReloadLoopSectionName);
 	}
@@ -288,7 +900,7 @@ void AGE_FireWeapon::Notify_CommitReload(bool bForceFull /*= false*/)
 
 	if (IsLocallyControlled())
 	{
-		ServerCommitReload(bForceFull);
+		SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::CommitReload, bForceFull));
 	}
 }
 
@@ -296,15 +908,15 @@ void AGE_FireWeapon::CancelReload()
 {
 	if (HasAuthority())
 	{
-		if (bIsReloading)
+		if (NetState.bIsReloading)
 		{
-			bIsReloading = false;
-			OnRep_IsReloading();
+			NetState.bIsReloading = false;
+			CommitState(EGE_WeaponStateField::Reloading);
 		}
 	}
 	else
 	{
-		ServerCancelReload();
+		SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::CancelReload));
 	}
 }
 
@@ -312,9 +924,9 @@ void AGE_FireWeapon::SetTotalAmmo(int32 NewTotal)
 {
 	if (HasAuthority())
 	{
-		const int32 OldTotalAmmo = TotalAmmo;
-		TotalAmmo = FMath::Max(0, NewTotal);
-		OnRep_TotalAmmo(OldTotalAmmo);
+		const int32 OldTotalAmmo = NetState.TotalAmmo;
+		NetState.TotalAmmo = FMath::Max(0, NewTotal);
+		CommitState(EGE_WeaponStateField::TotalAmmo, OldTotalAmmo);
 	}
 }
 
@@ -322,9 +934,9 @@ void AGE_FireWeapon::AddTotalAmmo(int32 Delta)
 {
 	if (HasAuthority() && Delta != 0)
 	{
-		const int32 OldTotalAmmo = TotalAmmo;
-		TotalAmmo = FMath::Max(0, TotalAmmo + Delta);
-		OnRep_TotalAmmo(OldTotalAmmo);
+		const int32 OldTotalAmmo = NetState.TotalAmmo;
+		NetState.TotalAmmo = FMath::Max(0, NetState.TotalAmmo + Delta);
+		CommitState(EGE_WeaponStateField::TotalAmmo, OldTotalAmmo);
 	}
 }
 
@@ -334,15 +946,15 @@ bool AGE_FireWeapon::CanReload() const
 	{
 		return false;
 	}
-	if (bIsReloading)
+	if (NetState.bIsReloading)
 	{
 		return false;
 	}
-	if (AmmoInMag >= MagazineCapacity)
+	if (NetState.AmmoInMag >= MagazineCapacity)
 	{
 		return false;
 	}
-	if (TotalAmmo <= 0)
+	if (NetState.TotalAmmo <= 0)
 	{
 		return false;
 	}
@@ -365,13 +977,12 @@ void AGE_FireWeapon::CycleFireMode()
 	{
 		if (HasAuthority())
 		{
-			RepFireMode = NextMode;
-			FireMode = NextMode;
-			OnRep_FireMode();
+			NetState.FireMode = NextMode;
+			CommitState(EGE_WeaponStateField::FireMode);
 		}
 		else
 		{
-			ServerSetFireMode(NextMode);
+			SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::SetFireMode, static_cast<uint8>(NextMode)));
 		}
 	}
 }
@@ -420,7 +1031,7 @@ FTransform AGE_FireWeapon::GetBulletSpawnTransform() const
 		}
 	}
 
-	const FTransform AimTf = bIsAiming && bOwnerIsFirstPerson ? SightTf : CameraTf;
+	const FTransform AimTf = NetState.bIsAiming && bOwnerIsFirstPerson ? SightTf : CameraTf;
 
 	FVector MuzzleInAim = UKismetMathLibrary::InverseTransformLocation(AimTf, Muzzle.GetLocation());
 	MuzzleInAim = UKismetMathLibrary::TransformLocation(AimTf, FVector(MuzzleInAim.X * 0.8f, 0.f, 0.f));
@@ -440,12 +1051,12 @@ void AGE_FireWeapon::InputCycleFireMode()
 
 void AGE_FireWeapon::BeginFire()
 {
-	if (bBlockFireWhileReloading && bIsReloading)
+	if (bBlockFireWhileReloading && NetState.bIsReloading)
 	{
 		return;
 	}
 
-	if (AmmoInMag <= 0)
+	if (NetState.AmmoInMag <= 0)
 	{
 		BP_OnOutOfAmmo();
 		return;
@@ -471,15 +1082,16 @@ void AGE_FireWeapon::EndFire()
 	if (FireMode == EGEFireMode::Burst && bBurstSequencing) return;
 
 	GetWorldTimerManager().ClearTimer(TimerHandle_Fire);
+	FireScheduler.Stop();
 
-	if (bIsFiring)
+	if (NetState.bIsFiring)
 	{
-		bIsFiring = false;
-		OnRep_IsFiring();
+		NetState.bIsFiring = false;
+		CommitState(EGE_WeaponStateField::Firing);
 
 		if (!HasAuthority())
 		{
-			ServerSetIsFiring(false);
+			SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::SetFiring, false));
 		}
 	}
 }
@@ -488,17 +1100,18 @@ void AGE_FireWeapon::BeginFire_Internal()
 {
 	if (!CanFire()) return;
 
-	if (!bIsFiring)
+	if (!NetState.bIsFiring)
 	{
-		bIsFiring = true;
-		OnRep_IsFiring();
+		NetState.bIsFiring = true;
+		CommitState(EGE_WeaponStateField::Firing);
 
 		if (!HasAuthority())
 		{
-			ServerSetIsFiring(true);
+			SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::SetFiring, true));
 		}
 	}
 
+	const double Now = GetWorld()->GetTimeSeconds();
 	const float Interval = GE_FireIntervalFromRPM(FireRateRPM);
 
 	if (FireMode == EGEFireMode::Burst)
@@ -507,24 +1120,40 @@ void AGE_FireWeapon::BeginFire_Internal()
 		{
 			bBurstSequencing = true;
 			BurstLeft = FMath::Max(1, BurstCount);
-			FireShot();
+			FireScheduler.Start(Now, Interval);
+			RefreshFireSchedule();
 		}
 	}
 	else if (FireMode == EGEFireMode::Auto)
 	{
-		if (!GetWorldTimerManager().IsTimerActive(TimerHandle_Fire))
+		if (!FireScheduler.IsActive())
 		{
-			FireShot();
-			GetWorldTimerManager().SetTimer(TimerHandle_Fire, this, &AGE_FireWeapon::FireShot, Interval, true);
+			FireScheduler.Start(Now, Interval);
+			RefreshFireSchedule();
 		}
 	}
 	else // Semi
 	{
-		FireShot();
+		FireShot(Now);
 	}
 }
 
-void AGE_FireWeapon::FireShot()
+void AGE_FireWeapon::RefreshFireSchedule()
+{
+	if (!FireScheduler.IsActive()) return;
+
+	FGE_FireScheduler::FShotTimes ShotTimes;
+	FireScheduler.Advance(GetWorld()->GetTimeSeconds(), ShotTimes);
+
+	for (const double ShotTime : ShotTimes)
+	{
+		FireShot(ShotTime);
+
+		if (!FireScheduler.IsActive()) break;
+	}
+}
+
+void AGE_FireWeapon::FireShot(double ShotTime)
 {
 	if (!CanFire())
 	{
@@ -532,11 +1161,12 @@ void AGE_FireWeapon::FireShot()
 		{
 			bBurstSequencing = false;
 			BurstLeft = 0;
+			FireScheduler.Stop();
 		}
 		return;
 	}
 
-	if (AmmoInMag <= 0)
+	if (NetState.AmmoInMag <= 0)
 	{
 		BP_OnOutOfAmmo();
 		
@@ -548,24 +1178,29 @@ void AGE_FireWeapon::FireShot()
 		{
 			bBurstSequencing = false;
 			BurstLeft = 0;
+			FireScheduler.Stop();
 		}
 		return;
 	}
 
-	FVector Start;
-	TArray<FVector> Dirs;
-	TArray<FVector> Ends;
-	ComputeShot(Start, Dirs, Ends);
+	RecoverImprecision(ShotTime);
+
+	FGE_BulletData Shot;
+	ComputeShot(Shot);
 
 	if (HasAuthority())
 	{
-		ApplyShot(Start, Dirs, Ends);
+		ApplyShot(Shot);
 	}
 	else
 	{
-		BulletData = FGE_BulletData(Start, Dirs, Ends);
+		NetState.BulletData = Shot;
 
-		ServerApplyShot(Start, BulletData.Directions, BulletData.EndLocations);
+		FGE_WeaponCommand Command(EGE_WeaponCommandType::Fire);
+		Command.Shot = Shot;
+		// Shots due earlier in the frame are rewound further
+		Command.FireTime = UGE_LagCompensationSubsystem::GetViewTimestamp(GetInstigator()) - (GetWorld()->GetTimeSeconds() - ShotTime);
+		SendCommand(MoveTemp(Command));
 	}
 
 	HandleShotFXAndRecoil();
@@ -573,12 +1208,7 @@ void AGE_FireWeapon::FireShot()
 	if (FireMode == EGEFireMode::Burst)
 	{
 		BurstLeft = FMath::Max(0, BurstLeft - 1);
-		if (BurstLeft > 0)
-		{
-			const float Interval = GE_FireIntervalFromRPM(FireRateRPM);
-			GetWorldTimerManager().SetTimer(TimerHandle_Fire, this, &AGE_FireWeapon::FireShot, Interval, false);
-		}
-		else
+		if (BurstLeft <= 0)
 		{
 			bBurstSequencing = false;
 			EndFire();
@@ -591,14 +1221,27 @@ void AGE_FireWeapon::HandleShotFXAndRecoil()
 	BP_OnFiredFX();
 	BP_OnRecoilPlay();
 
-	TArray<FHitResult> Hits;
-	if (GetHitResult(Hits))
+	if (OwningCharacterInterface)
+	{
+		OwningCharacterInterface->OnWeaponFired(this, NetState.BulletData.ShotSequence, BulletFired);
+	}
+
+	TArray<FGE_ShotHit> Hits;
+	if (bSimulateProjectiles)
 	{
-		for (const FHitResult& Hit : Hits)
+		// Impacts come from the cosmetic bullets once they land
+		if (GetNetMode() != NM_DedicatedServer)
+		{
+			LaunchProjectiles(-1.0, true);
+		}
+	}
+	else if (ShouldTraceImpactFX() && GetHitResult(Hits))
+	{
+		for (const FGE_ShotHit& Hit : Hits)
 		{
 			if (Hit.IsValidBlockingHit())
 			{
-				SpawnImpactFXHandler(GetHitResultWithPhysMaterial(Hit));
+				SpawnImpactFXHandler(Hit);
 			}
 		}
 	}
@@ -615,65 +1258,67 @@ void AGE_FireWeapon::HandleShotFXAndRecoil()
 	BulletFired += 1;
 }
 
-bool AGE_FireWeapon::GetHitResult(TArray<FHitResult>& OutHits) const
+bool AGE_FireWeapon::ShouldTraceImpactFX() const
 {
-	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponTrace), true, GetOwner());
-	Params.bReturnPhysicalMaterial = false;
-	Params.bReturnFaceIndex = !UPhysicsSettings::Get()->bSuppressFaceRemapTable;
+	// The server already traced the shot for damage, the FX traces only pay off where someone can see or hear them
+	if (GetNetMode() == NM_DedicatedServer) return false;
+
+	const UGE_ImpactFXSubsystem* ImpactFX = GetWorld()->GetSubsystem<UGE_ImpactFXSubsystem>();
+	if (!ImpactFX) return true;
 
-	for (const FVector_NetQuantize100& EndLocation : BulletData.EndLocations)
+	for (const FVector_NetQuantize100& EndLocation : NetState.BulletData.EndLocations)
 	{
-		FHitResult OutHit{ ForceInit };
-		GetWorld()->LineTraceSingleByChannel(OutHit, BulletData.StartLocation, EndLocation, TraceChannel, Params);
-		OutHits.Add(OutHit);
+		if (ImpactFX->IsShotInRange(NetState.BulletData.StartLocation, EndLocation)) return true;
 	}
-
-	return OutHits.Num() > 0;
+	return false;
 }
 
-FHitResult AGE_FireWeapon::GetHitResultWithPhysMaterial(const FHitResult& InHit) const
+bool AGE_FireWeapon::GetHitResult(TArray<FGE_ShotHit>& OutHits) const
 {
-	FHitResult ActualHitResult = InHit;
-	EPhysicalSurface SurfaceType = EPhysicalSurface::SurfaceType_Default;
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponTrace), true, GetOwner());
+	Params.bReturnPhysicalMaterial = true;
+	Params.bReturnFaceIndex = !UPhysicsSettings::Get()->bSuppressFaceRemapTable;
 
-	// Check for complex phys mat (material physic default)
-	if (UPhysicalMaterial* PhysMaterial = InHit.PhysMaterial.Get())
+	if (PenetrationData)
 	{
-		SurfaceType = PhysMaterial->SurfaceType;
-	}
+		TArray<FHitResult> Hits;
+		TArray<FGE_ShotHit> Entries;
 
-	constexpr float Distance = 10.0f;
-	FCollisionQueryParams CollisionParams;
-	CollisionParams.bReturnPhysicalMaterial = true;
-	CollisionParams.bReturnFaceIndex = !UPhysicsSettings::Get()->bSuppressFaceRemapTable;
-	CollisionParams.bTraceComplex = false;
-	CollisionParams.AddIgnoredActor(GetOwner());
+		for (const FVector_NetQuantize100& EndLocation : NetState.BulletData.EndLocations)
+		{
+			Hits.Reset();
+			GetWorld()->LineTraceMultiByChannel(Hits, NetState.BulletData.StartLocation, EndLocation, TraceChannel, Params, UGE_PenetrationData::GetEntryResponseParams());
 
-	const FVector ForwardVector = (InHit.TraceEnd - InHit.TraceStart).GetSafeNormal();
-	const FVector& Start = InHit.Location - (ForwardVector * Distance);
-	const FVector& End = InHit.Location + (ForwardVector * Distance);
+			Entries.Reset();
+			for (const FHitResult& Hit : Hits)
+			{
+				Entries.Add(FGE_ShotHit::Resolve(Hit));
+			}
 
-	FHitResult Hit(ForceInit);
-	bool bIsHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, TraceChannel, CollisionParams);
-	if (bIsHit && InHit.GetActor() == Hit.GetActor())
-	{
-		if (UPhysicalMaterial* PhysicalMaterial = Hit.PhysMaterial.Get())
-		{
-			ActualHitResult.PhysMaterial = Hit.PhysMaterial;
+			PenetrationData->ResolvePellet(GetWorld(), NetState.BulletData.StartLocation, EndLocation, TraceChannel, Params, Entries, OutHits);
 		}
 
-		ActualHitResult.Location = Hit.Location;
-		ActualHitResult.Normal = Hit.Normal;
-		ActualHitResult.ImpactPoint = Hit.ImpactPoint;
-		ActualHitResult.ImpactNormal = Hit.ImpactNormal;
+		return OutHits.Num() > 0;
 	}
 
-	return ActualHitResult;
+	for (const FVector_NetQuantize100& EndLocation : NetState.BulletData.EndLocations)
+	{
+		FHitResult OutHit{ ForceInit };
+		GetWorld()->LineTraceSingleByChannel(OutHit, NetState.BulletData.StartLocation, EndLocation, TraceChannel, Params);
+		OutHits.Add(FGE_ShotHit::Resolve(OutHit));
+	}
+
+	return OutHits.Num() > 0;
 }
 
-void AGE_FireWeapon::SpawnImpactFXHandler(const FHitResult& InHit)
+void AGE_FireWeapon::SpawnImpactFXHandler(const FGE_ShotHit& InHit)
 {
-	// #TODO
+	if (!ImpactFXData) return;
+
+	if (UGE_ImpactFXSubsystem* ImpactFX = GetWorld()->GetSubsystem<UGE_ImpactFXSubsystem>())
+	{
+		ImpactFX->SpawnImpact(ImpactFXData, InHit);
+	}
 }
 
 bool AGE_FireWeapon::CanFire() const
@@ -682,7 +1327,7 @@ bool AGE_FireWeapon::CanFire() const
 	{
 		return false;
 	}
-	if (bBlockFireWhileReloading && bIsReloading)
+	if (bBlockFireWhileReloading && NetState.bIsReloading)
 	{
 		return false;
 	}
@@ -699,12 +1344,12 @@ void AGE_FireWeapon::OnRunFireDelayElapsed()
 {
 	bRunFireDelayActive = false;
 
-	if (bBlockFireWhileReloading && bIsReloading)
+	if (bBlockFireWhileReloading && NetState.bIsReloading)
 	{
 		return;
 	}
 
-	if (AmmoInMag <= 0)
+	if (NetState.AmmoInMag <= 0)
 	{
 		BP_OnOutOfAmmo();
 		return;
@@ -716,97 +1361,177 @@ void AGE_FireWeapon::OnRunFireDelayElapsed()
 		return;
 	}
 
-	if (!bIsFiring)
+	if (!NetState.bIsFiring)
 	{
-		bIsFiring = true;
+		NetState.bIsFiring = true;
 		if (HasAuthority())
 		{
-			OnRep_IsFiring();
+			CommitState(EGE_WeaponStateField::Firing);
 		}
 		else
 		{
-			ServerSetIsFiring(true);
+			SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::SetFiring, true));
 		}
 	}
 
-	FireShot();
+	FireShot(GetWorld()->GetTimeSeconds());
 
 	const float Delay = GE_FireIntervalFromRPM(FireRateRPM);
 	GetWorldTimerManager().SetTimer(TimerHandle_Fire, this, &AGE_FireWeapon::EndFire, Delay, false);
 }
 
-void AGE_FireWeapon::ComputeShot(FVector& OutStart, TArray<FVector>& OutDirs, TArray<FVector>& OutEnds)
+void AGE_FireWeapon::ComputeShot(FGE_BulletData& OutData)
 {
 	const FTransform BulletSpawnTransform = GetBulletSpawnTransform();
-	OutStart = BulletSpawnTransform.GetLocation();
-	FRotator Rot = BulletSpawnTransform.GetRotation().Rotator();
 
 	const ACharacter* C = Cast<ACharacter>(GetOwner());
 	const FVector Vel = C ? C->GetVelocity() : FVector::ZeroVector;
-	const float AimRatio = bIsAiming ? 1.f : 0.f;
+	const float AimRatio = NetState.bIsAiming ? 1.f : 0.f;
 
 	const float Spread = ProjectilesPerShot == 1 ? GetImprecision(AimRatio, Vel) : 2.0f;
 
-	for (int32 i = 0; i < ProjectilesPerShot; ++i)
+	OutData = FGE_BulletData(BulletSpawnTransform.GetLocation(), BulletSpawnTransform.GetRotation().Rotator(), Spread, ++ShotSequence);
+
+	// Predict from the same values the server and observers will decode
+	OutData.Quantize();
+	OutData.GenerateDirections(ProjectilesPerShot, TraceDist);
+}
+
+void AGE_FireWeapon::ApplyShot(const FGE_BulletData& InData, double FireTime)
+{
+	if (bBlockFireWhileReloading && NetState.bIsReloading)
 	{
-		if (Spread > 0.f)
-		{
-			const FRotator RandRot(FMath::RandRange(-Spread, Spread), FMath::RandRange(-Spread, Spread), FMath::RandRange(-Spread, Spread));
-			Rot += RandRot;
-		}
+		return;
+	}
+
+	if (!ConsumeOneFromMagazine())
+	{
+		return;
+	}
+
+	if (FireTime >= 0.0)
+	{
+		RecoverImprecision(FireTime);
+	}
 
-		FVector OutDir = Rot.GetNormalized().Vector();
-		OutDirs.Add(OutDir);
+	NetState.BulletData = InData;
+	NetState.BulletData.GenerateDirections(ProjectilesPerShot, TraceDist);
+	CommitState(EGE_WeaponStateField::Bullet);
 
-		OutEnds.Add(OutStart + OutDir * TraceDist);
+	if (bSimulateProjectiles)
+	{
+		LaunchProjectiles(FireTime, false);
+		return;
+	}
+
+	UGE_HitscanSubsystem* Hitscan = GetWorld()->GetSubsystem<UGE_HitscanSubsystem>();
+	if (!Hitscan)
+	{
+		return;
+	}
+
+	for (const FVector_NetQuantize100& EndLocation : NetState.BulletData.EndLocations)
+	{
+		Hitscan->QueueTrace(this, NetState.BulletData.ShotSequence, NetState.BulletData.StartLocation, EndLocation, TraceChannel, FireTime);
 	}
 }
 
-void AGE_FireWeapon::ApplyShot(const FVector& Start, const TArray<FVector>& Dirs, const TArray<FVector>& Ends)
+void AGE_FireWeapon::LaunchProjectiles(double RewindTimestamp, bool bCosmetic)
 {
-	if (bBlockFireWhileReloading && bIsReloading)
+	UGE_ProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UGE_ProjectileSubsystem>();
+	if (!Projectiles)
 	{
 		return;
 	}
 
-	if (!ConsumeOneFromMagazine())
+	for (const FVector& Direction : NetState.BulletData.Directions)
+	{
+		Projectiles->Launch(this, NetState.BulletData.ShotSequence, NetState.BulletData.StartLocation, Direction * MuzzleVelocity, RewindTimestamp, bCosmetic);
+	}
+}
+
+void AGE_FireWeapon::HandleShotHit(const FGE_ShotHit& ShotHit, uint16 ShotSequence)
+{
+	if (!ShotHit.IsValidBlockingHit())
 	{
 		return;
 	}
 
-	BulletData = FGE_BulletData(Start, Dirs, Ends);
-	OnRep_BulletData();
+	const FHitResult& Hit = ShotHit.Hit;
+	AActor* Victim = Hit.GetActor();
+	if (!Victim || !Victim->CanBeDamaged())
+	{
+		return;
+	}
 
-	TArray<FHitResult> Hits;
-	if (GetHitResult(Hits))
+	// Several shots can resolve in one pass at high fire rates, each keeps its own event
+	FGE_ShotDamageEvent* Dmg = PendingShotDamage.FindByPredicate([Victim, ShotSequence](const FGE_ShotDamageEvent& Pending)
 	{
-		for (int32 i = 0; i < Hits.Num(); ++i)
-		{
-			if (!Dirs.IsValidIndex(i) || !Ends.IsValidIndex(i)) continue;
+		return Pending.ShotSequence == ShotSequence && Pending.HitInfo.GetActor() == Victim;
+	});
 
-			const FHitResult& Hit = Hits[i];
-			const FVector& Dir = Dirs[i];
-			const FVector& End = Ends[i];
+	if (!Dmg)
+	{
+		Dmg = &PendingShotDamage.AddDefaulted_GetRef();
+		Dmg->DamageTypeClass = DamageTypeClass ? DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+		Dmg->ShotDirection = (Hit.TraceEnd - Hit.TraceStart).GetSafeNormal();
+		Dmg->HitInfo = Hit;
+		Dmg->PelletDamage = BaseDamage;
+		Dmg->ShotSequence = ShotSequence;
+		Dmg->Damage = 0.f;
+	}
 
-			if (Hit.IsValidBlockingHit())
-			{
-				if (Hit.GetActor() && Hit.GetActor()->CanBeDamaged())
-				{
-					FPointDamageEvent Dmg;
-					Dmg.DamageTypeClass = UDamageType::StaticClass();
-					if (DamageTypeClass) { Dmg.DamageTypeClass = DamageTypeClass; }
-					Dmg.ShotDirection = Dir;
-					Dmg.HitInfo = Hit;
-					Dmg.Damage = BaseDamage;
-
-					AController* Instig = OwningCharacter.IsValid() ? OwningCharacter->GetController() : nullptr;
-					Hit.GetActor()->TakeDamage(Dmg.Damage, Dmg, Instig, this);
-				}
-			}
+	// Range and zone fold into the pellet's scale, so the victim sees the same per pellet damage
+	FGE_ShotHit& Pellet = Dmg->PelletHits.Add_GetRef(ShotHit);
+	if (DamageProfile)
+	{
+		Pellet.DamageScale *= DamageProfile->GetLUT().GetHitScale(ShotHit.Range, ShotHit.DamageZone);
+	}
+	Dmg->Damage += BaseDamage * Pellet.DamageScale;
+
+	INC_DWORD_STAT(STAT_GE_ShotDamagePellets);
+}
+
+void AGE_FireWeapon::ApplyPendingShotDamage()
+{
+	if (PendingShotDamage.Num() == 0)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT_BY(STAT_GE_ShotDamageEvents, PendingShotDamage.Num());
+
+	AController* Instig = OwningCharacter.IsValid() ? OwningCharacter->GetController() : nullptr;
+
+	// Damage can kill the owner and release this weapon, so work from a local copy
+	TArray<FGE_ShotDamageEvent, TInlineAllocator<2>> Pending = MoveTemp(PendingShotDamage);
+	PendingShotDamage.Reset();
+
+	for (const FGE_ShotDamageEvent& Dmg : Pending)
+	{
+		AActor* Victim = Dmg.HitInfo.GetActor();
+		if (IsValid(Victim) && Victim->CanBeDamaged())
+		{
+			Victim->TakeDamage(Dmg.Damage, Dmg, Instig, this);
 		}
 	}
 }
 
+void AGE_FireWeapon::RecoverImprecision(double ShotTime)
+{
+	if (LastShotTime >= 0.0)
+	{
+		const double Interval = GE_FireIntervalFromRPM(FireRateRPM);
+		const int32 SkippedShots = FMath::FloorToInt32((ShotTime - LastShotTime) / Interval + UE_KINDA_SMALL_NUMBER) - 1;
+		if (SkippedShots > 0)
+		{
+			Imprecision = FMath::Min(MaxImprecision, Imprecision + SkippedShots);
+		}
+	}
+
+	LastShotTime = ShotTime;
+}
+
 float AGE_FireWeapon::GetImprecision(float AimingRatio, const FVector& OwnerVelocity) const
 {
 	const float ImprecisionRatio = static_cast<float>(Imprecision) / static_cast<float>(MaxImprecision);
@@ -820,9 +1545,9 @@ bool AGE_FireWeapon::ConsumeOneFromMagazine()
 {
 	if (!HasAuthority()) return false;
 
-	if (AmmoInMag <= 0) return false;
+	if (NetState.AmmoInMag <= 0) return false;
 
-	SetAmmoInMag(AmmoInMag - 1);
+	SetAmmoInMag(NetState.AmmoInMag - 1);
 	return true;
 }
 
@@ -830,16 +1555,16 @@ int32 AGE_FireWeapon::LoadFromReserve(int32 Desired)
 {
 	if (!HasAuthority() || Desired <= 0) return 0;
 
-	const int32 Space = FMath::Max(0, MagazineCapacity - AmmoInMag);
+	const int32 Space = FMath::Max(0, MagazineCapacity - NetState.AmmoInMag);
 
-	if (Space <= 0 || TotalAmmo <= 0) return 0;
+	if (Space <= 0 || NetState.TotalAmmo <= 0) return 0;
 
-	const int32 ToMove = FMath::Min3(Desired, Space, TotalAmmo);
-	SetAmmoInMag(AmmoInMag + ToMove);
+	const int32 ToMove = FMath::Min3(Desired, Space, NetState.TotalAmmo);
+	SetAmmoInMag(NetState.AmmoInMag + ToMove);
 
-	const int32 OldTotalAmmo = TotalAmmo;
-	TotalAmmo -= ToMove;
-	OnRep_TotalAmmo(OldTotalAmmo);
+	const int32 OldTotalAmmo = NetState.TotalAmmo;
+	NetState.TotalAmmo -= ToMove;
+	CommitState(EGE_WeaponStateField::TotalAmmo, OldTotalAmmo);
 
 	return ToMove;
 }
@@ -849,21 +1574,21 @@ void AGE_FireWeapon::SetAmmoInMag(int32 NewAmount)
 	if (!HasAuthority()) return;
 
 	const int32 Clamped = FMath::Clamp(NewAmount, 0, MagazineCapacity);
-	if (AmmoInMag != Clamped)
+	if (NetState.AmmoInMag != Clamped)
 	{
-		AmmoInMag = Clamped;
-		OnRep_AmmoInMag();
+		NetState.AmmoInMag = Clamped;
+		CommitState(EGE_WeaponStateField::AmmoInMag);
 	}
 }
 
 void AGE_FireWeapon::SetIsAiming(bool bNew)
 {
-	if (bIsAiming == bNew) return;
+	if (NetState.bIsAiming == bNew) return;
 
 	RefreshADSOffset();
 
-	bIsAiming = bNew;
-	OnRep_IsAiming();
+	NetState.bIsAiming = bNew;
+	CommitState(EGE_WeaponStateField::Aiming);
 
 	if (OwningCharacterInterface)
 	{
@@ -872,17 +1597,17 @@ void AGE_FireWeapon::SetIsAiming(bool bNew)
 
 	if (!HasAuthority())
 	{
-		ServerSetIsAiming(bNew);
+		SendCommand(FGE_WeaponCommand(EGE_WeaponCommandType::SetAiming, bNew));
 	}
 }
 
 void AGE_FireWeapon::RefreshAimingTimeline(float DeltaSeconds)
 {
-	const float TargetADS = bIsAiming ? 1.f : 0.f;
-	const float TargetFOV = bIsAiming ? 1.f : 0.f;
+	const float TargetADS = NetState.bIsAiming ? 1.f : 0.f;
+	const float TargetFOV = NetState.bIsAiming ? 1.f : 0.f;
 
-	const float InSpeed = bIsAiming ? AimInSpeed : AimOutSpeed;
-	const float OutSpeed = bIsAiming ? AimInSpeed : AimOutSpeed;
+	const float InSpeed = NetState.bIsAiming ? AimInSpeed : AimOutSpeed;
+	const float OutSpeed = NetState.bIsAiming ? AimInSpeed : AimOutSpeed;
 
 	ADSPlayback = FMath::FInterpTo(ADSPlayback, TargetADS, DeltaSeconds, InSpeed);
 	FOVPlayback = FMath::FInterpTo(FOVPlayback, TargetFOV, DeltaSeconds, OutSpeed);
@@ -902,148 +1627,380 @@ void AGE_FireWeapon::RefreshADSOffset()
 	BP_OnRefreshADSOffset(ADSOffset);
 }
 
-void AGE_FireWeapon::ServerSetIsFiring_Implementation(bool bNew)
+void AGE_FireWeapon::SendCommand(FGE_WeaponCommand&& Command)
 {
-	bIsFiring = bNew;
-	OnRep_IsFiring();
+	if (HasAuthority())
+	{
+		ExecuteCommand(Command);
+		return;
+	}
+
+	if (UnackedCommands.Commands.Num() >= FGE_WeaponCommandPacket::MaxCommands)
+	{
+		// The server is far behind or unreachable. Drop the oldest, replicated state corrects whatever it carried.
+		UnackedCommands.Commands.RemoveAt(0, 1, EAllowShrinking::No);
+		INC_DWORD_STAT(STAT_GE_WeaponCommandOverflows);
+	}
+
+	Command.Sequence = ++OutgoingCommandSequence;
+	const FGE_WeaponCommand& Queued = UnackedCommands.Commands.Add_GetRef(MoveTemp(Command));
+
+	if (IsPredictingState())
+	{
+		PredictCommand(Queued);
+	}
+
+	// Everything queued this frame goes out together
+	if (!bCommandFlushPending)
+	{
+		bCommandFlushPending = true;
+		GetWorldTimerManager().SetTimerForNextTick(this, &AGE_FireWeapon::FlushCommands);
+	}
 }
 
-void AGE_FireWeapon::ServerSetIsAiming_Implementation(bool bNew)
+void AGE_FireWeapon::FlushCommands()
 {
-	bIsAiming = bNew;
-	OnRep_IsAiming();
+	bCommandFlushPending = false;
+	GetWorldTimerManager().ClearTimer(TimerHandle_CommandResend);
+
+	if (UnackedCommands.Commands.Num() == 0)
+	{
+		return;
+	}
+
+#if STATS
+	{
+		FBitWriter Writer(0, true);
+		bool bSuccess;
+		UnackedCommands.NetSerialize(Writer, nullptr, bSuccess);
+		GE_RecordCommandBytes(static_cast<int32>(Writer.GetNumBytes()));
+	}
+#endif
+
+	ServerSendCommands(UnackedCommands);
+
+	// Keep repeating until acked, a lost packet is covered by the next one
+	GetWorldTimerManager().SetTimer(TimerHandle_CommandResend, this, &AGE_FireWeapon::FlushCommands, CVarWeaponCommandResendInterval.GetValueOnGameThread(), false);
 }
 
-void AGE_FireWeapon::ServerRequestStartReload_Implementation()
+void AGE_FireWeapon::ExecuteCommand(const FGE_WeaponCommand& Command)
 {
-	if (CanReload() && !bIsReloading)
+	switch (Command.Type)
 	{
-		bIsReloading = true;
-		OnRep_IsReloading();
+		case EGE_WeaponCommandType::Fire:         ApplyShot(Command.Shot, Command.FireTime); break;
+		case EGE_WeaponCommandType::SetFiring:    ExecuteSetIsFiring(Command.Param != 0); break;
+		case EGE_WeaponCommandType::SetAiming:    ExecuteSetIsAiming(Command.Param != 0); break;
+		case EGE_WeaponCommandType::StartReload:  ExecuteStartReload(); break;
+		case EGE_WeaponCommandType::InsertRound:  ExecuteInsertOneRound(); break;
+		case EGE_WeaponCommandType::CommitReload: ExecuteCommitReload(Command.Param != 0); break;
+		case EGE_WeaponCommandType::CancelReload: ExecuteCancelReload(); break;
+		case EGE_WeaponCommandType::SetFireMode:
+			if (Command.Param <= static_cast<uint8>(EGEFireMode::Auto))
+			{
+				ExecuteSetFireMode(static_cast<EGEFireMode>(Command.Param));
+			}
+			break;
 	}
 }
 
-void AGE_FireWeapon::ServerInsertOneRound_Implementation()
+void AGE_FireWeapon::ResetCommandStream()
 {
-	if (!bLoopReload || !bIsReloading) return;
+	GetWorldTimerManager().ClearTimer(TimerHandle_CommandResend);
+	UnackedCommands.Commands.Reset();
+	PredictionHistory.Reset();
+	bCommandFlushPending = false;
+	bHasConfirmedState = false;
+
+	OutgoingCommandSequence = 0;
+	LastExecutedCommandSequence = 0;
+
+	AckedCommandSequence = 0;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_FireWeapon, AckedCommandSequence, this);
+}
+
+void AGE_FireWeapon::ServerSendCommands_Implementation(const FGE_WeaponCommandPacket& Packet)
+{
+	for (const FGE_WeaponCommand& Command : Packet.Commands)
+	{
+		if (!GE_IsSequenceNewer(Command.Sequence, LastExecutedCommandSequence)) continue;
+
+		LastExecutedCommandSequence = Command.Sequence;
+		ExecuteCommand(Command);
+	}
+
+	AckedCommandSequence = LastExecutedCommandSequence;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_FireWeapon, AckedCommandSequence, this);
+	FlushDehydratedState();
+}
+
+void AGE_FireWeapon::ExecuteSetIsFiring(bool bNew)
+{
+	NetState.bIsFiring = bNew;
+	CommitState(EGE_WeaponStateField::Firing);
+}
+
+void AGE_FireWeapon::ExecuteSetIsAiming(bool bNew)
+{
+	NetState.bIsAiming = bNew;
+	CommitState(EGE_WeaponStateField::Aiming);
+}
+
+void AGE_FireWeapon::ExecuteStartReload()
+{
+	if (CanReload() && !NetState.bIsReloading)
+	{
+		NetState.bIsReloading = true;
+		CommitState(EGE_WeaponStateField::Reloading);
+	}
+}
+
+void AGE_FireWeapon::ExecuteInsertOneRound()
+{
+	if (!bLoopReload || !NetState.bIsReloading) return;
 
 	const int32 Moved = LoadFromReserve(1);
-	const bool bDone = (Moved <= 0) || (AmmoInMag >= MagazineCapacity) || (TotalAmmo <= 0);
+	const bool bDone = (Moved <= 0) || (NetState.AmmoInMag >= MagazineCapacity) || (NetState.TotalAmmo <= 0);
 	if (bDone)
 	{
-		bIsReloading = false;
-		OnRep_IsReloading();
+		NetState.bIsReloading = false;
+		CommitState(EGE_WeaponStateField::Reloading);
 	}
 }
 
-void AGE_FireWeapon::ServerCommitReload_Implementation(bool bForceFull)
+void AGE_FireWeapon::ExecuteCommitReload(bool bForceFull)
 {
-	if (!bIsReloading) return;
+	if (!NetState.bIsReloading) return;
 
-	const int32 Need = FMath::Max(0, MagazineCapacity - AmmoInMag);
+	const int32 Need = FMath::Max(0, MagazineCapacity - NetState.AmmoInMag);
 	if (Need > 0)
 	{
 		LoadFromReserve(Need);
 	}
 
-	bIsReloading = false;
-	OnRep_IsReloading();
+	NetState.bIsReloading = false;
+	CommitState(EGE_WeaponStateField::Reloading);
 }
 
-void AGE_FireWeapon::ServerCancelReload_Implementation()
+void AGE_FireWeapon::ExecuteCancelReload()
 {
-	if (bIsReloading)
+	if (NetState.bIsReloading)
 	{
-		bIsReloading = false;
-		OnRep_IsReloading();
+		NetState.bIsReloading = false;
+		CommitState(EGE_WeaponStateField::Reloading);
 	}
 }
 
-void AGE_FireWeapon::ServerApplyShot_Implementation(const FVector_NetQuantize100& Start, const TArray<FVector_NetQuantizeNormal>& Dirs, const TArray<FVector_NetQuantize100>& Ends)
+void AGE_FireWeapon::ExecuteSetFireMode(EGEFireMode NewMode)
 {
-	TArray<FVector> TargetDirs;
-	TArray<FVector> TargetEnds;
-	TargetDirs.Reserve(Dirs.Num());
-	TargetEnds.Reserve(Ends.Num());
+	NetState.FireMode = NewMode;
+	CommitState(EGE_WeaponStateField::FireMode);
+}
 
-	for (const FVector_NetQuantizeNormal& Dir : Dirs)
-	{
-		TargetDirs.Add(Dir);
-	}
+FGE_WeaponPredictedState AGE_FireWeapon::CaptureState() const
+{
+	FGE_WeaponPredictedState State;
+	State.AmmoInMag = NetState.AmmoInMag;
+	State.TotalAmmo = NetState.TotalAmmo;
+	State.bIsReloading = NetState.bIsReloading;
+	State.FireMode = NetState.FireMode;
+	return State;
+}
+
+void AGE_FireWeapon::RestoreState(const FGE_WeaponPredictedState& State)
+{
+	NetState.AmmoInMag = State.AmmoInMag;
+	NetState.TotalAmmo = State.TotalAmmo;
+	NetState.bIsReloading = State.bIsReloading;
+	NetState.FireMode = State.FireMode;
+	FireMode = State.FireMode;
+}
+
+void AGE_FireWeapon::ApplyPredictedState(const FGE_WeaponPredictedState& NewState)
+{
+	const FGE_WeaponPredictedState OldState = CaptureState();
+	RestoreState(NewState);
+
+	EGE_WeaponStateField ChangedFields = EGE_WeaponStateField::None;
+	if (OldState.AmmoInMag != NewState.AmmoInMag) { ChangedFields |= EGE_WeaponStateField::AmmoInMag; }
+	if (OldState.TotalAmmo != NewState.TotalAmmo) { ChangedFields |= EGE_WeaponStateField::TotalAmmo; }
+	if (OldState.bIsReloading != NewState.bIsReloading) { ChangedFields |= EGE_WeaponStateField::Reloading; }
+	if (OldState.FireMode != NewState.FireMode) { ChangedFields |= EGE_WeaponStateField::FireMode; }
+
+	// Pickup sound is left to PostNetReceive, which only plays it for confirmed gains
+	DispatchStateChanged(ChangedFields);
+}
+
+void AGE_FireWeapon::PredictCommand(const FGE_WeaponCommand& Command)
+{
+	FGE_WeaponPredictedState State = CaptureState();
+	SimulateCommand(State, Command);
+	ApplyPredictedState(State);
 
-	for (const FVector_NetQuantizeNormal& End : Ends)
+	if (PredictionHistory.Num() >= FGE_WeaponCommandPacket::MaxCommands)
 	{
-		TargetEnds.Add(End);
+		PredictionHistory.RemoveAt(0, 1, EAllowShrinking::No);
 	}
 
-	ApplyShot(Start, TargetDirs, TargetEnds);
+	FGE_WeaponPrediction& Prediction = PredictionHistory.AddDefaulted_GetRef();
+	Prediction.CommandSequence = Command.Sequence;
+	Prediction.ShotSequence = Command.Type == EGE_WeaponCommandType::Fire ? Command.Shot.ShotSequence : ShotSequence;
+	Prediction.State = State;
 }
 
-void AGE_FireWeapon::ServerSetFireMode_Implementation(EGEFireMode NewMode)
+void AGE_FireWeapon::SimulateCommand(FGE_WeaponPredictedState& State, const FGE_WeaponCommand& Command) const
 {
-	RepFireMode = NewMode;
-	FireMode = NewMode;
-	OnRep_FireMode();
+	auto LoadFromReserve = [this, &State](int32 Desired)
+	{
+		const int32 ToMove = FMath::Min3(Desired, FMath::Max(0, MagazineCapacity - State.AmmoInMag), State.TotalAmmo);
+		if (ToMove <= 0) return 0;
+
+		State.AmmoInMag += ToMove;
+		State.TotalAmmo -= ToMove;
+		return ToMove;
+	};
+
+	switch (Command.Type)
+	{
+		case EGE_WeaponCommandType::Fire:
+			if (!(bBlockFireWhileReloading && State.bIsReloading) && State.AmmoInMag > 0)
+			{
+				--State.AmmoInMag;
+			}
+			break;
+
+		case EGE_WeaponCommandType::StartReload:
+			if (IsEquipped() && !State.bIsReloading && State.AmmoInMag < MagazineCapacity && State.TotalAmmo > 0)
+			{
+				State.bIsReloading = true;
+			}
+			break;
+
+		case EGE_WeaponCommandType::InsertRound:
+			if (bLoopReload && State.bIsReloading)
+			{
+				const int32 Moved = LoadFromReserve(1);
+				if (Moved <= 0 || State.AmmoInMag >= MagazineCapacity || State.TotalAmmo <= 0)
+				{
+					State.bIsReloading = false;
+				}
+			}
+			break;
+
+		case EGE_WeaponCommandType::CommitReload:
+			if (State.bIsReloading)
+			{
+				LoadFromReserve(MagazineCapacity);
+				State.bIsReloading = false;
+			}
+			break;
+
+		case EGE_WeaponCommandType::CancelReload:
+			State.bIsReloading = false;
+			break;
+
+		case EGE_WeaponCommandType::SetFireMode:
+			if (Command.Param <= static_cast<uint8>(EGEFireMode::Auto))
+			{
+				State.FireMode = static_cast<EGEFireMode>(Command.Param);
+			}
+			break;
+
+		default:
+			break;
+	}
 }
 
-void AGE_FireWeapon::OnRep_AmmoInMag()
+void AGE_FireWeapon::CommitState(EGE_WeaponStateField ChangedFields, int32 OldTotalAmmo)
 {
-	OnAmmunitionChanged.Broadcast(AmmoInMag, TotalAmmo);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AGE_FireWeapon, NetState, this);
+	FlushDehydratedState();
+
+	DispatchStateChanged(ChangedFields, OldTotalAmmo);
 }
 
-void AGE_FireWeapon::OnRep_TotalAmmo(int32 OldTotalAmmo)
+void AGE_FireWeapon::DispatchStateChanged(EGE_WeaponStateField ChangedFields, int32 OldTotalAmmo)
 {
-	OnAmmunitionChanged.Broadcast(AmmoInMag, TotalAmmo);
+	if (ChangedFields == EGE_WeaponStateField::None) return;
 
-	if (GetNetMode() != NM_DedicatedServer)
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::AmmoInMag | EGE_WeaponStateField::TotalAmmo))
 	{
-		if (TotalAmmo > OldTotalAmmo)
+		OnAmmunitionChanged.Broadcast(NetState.AmmoInMag, NetState.TotalAmmo);
+	}
+
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::TotalAmmo) && OldTotalAmmo != INDEX_NONE && GetNetMode() != NM_DedicatedServer)
+	{
+		if (NetState.TotalAmmo > OldTotalAmmo)
 		{
 			UGameplayStatics::SpawnSoundAtLocation(this, AmmoPickupSound, GetActorLocation());
 		}
 	}
-}
 
-void AGE_FireWeapon::OnRep_IsFiring()
-{
-	if (bIsFiring)
-	{
-		// ...
-	}
-	else
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::Firing) && !NetState.bIsFiring)
 	{
 		BP_OnRecoilStop();
 
 		Imprecision = MaxImprecision;
 		BulletFired = 0;
+		LastShotTime = -1.0;
 	}
-}
 
-void AGE_FireWeapon::OnRep_IsReloading()
-{
-	if (bIsReloading)
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::Reloading) && NetState.bIsReloading)
 	{
 		PlayEquipmentMontageSet(ReloadAnim, /*FP*/IsLocallyControlled(), /*TP*/true);
 	}
+
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::Aiming))
+	{
+		BP_OnAimChanged(NetState.bIsAiming);
+	}
+
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::FireMode))
+	{
+		FireMode = NetState.FireMode;
+		OnFireModeChanged.Broadcast(FireMode);
+	}
+
+	if (EnumHasAnyFlags(ChangedFields, EGE_WeaponStateField::Bullet))
+	{
+		if (!HasAuthority())
+		{
+			NetState.BulletData.GenerateDirections(ProjectilesPerShot, TraceDist);
+		}
+
+		if (!IsLocallyControlled())
+		{
+			HandleShotFXAndRecoil();
+		}
+	}
+
+	OnWeaponStateChanged.Broadcast(static_cast<int32>(ChangedFields));
 }
 
-void AGE_FireWeapon::OnRep_IsAiming()
+void AGE_FireWeapon::OnRep_NetState()
 {
-	BP_OnAimChanged(bIsAiming);
+	// The owner already applied the server state on top of its prediction in PostNetReceive
+	if (bStateReconciled) return;
+
+	DispatchStateChanged(NetState.ChangedFields, NetState.PreviousTotalAmmo);
 }
 
-void AGE_FireWeapon::OnRep_BulletData()
+void AGE_FireWeapon::OnRep_AckedCommandSequence()
 {
-	if (!IsLocallyControlled())
+	int32 NumAcked = 0;
+	while (NumAcked < UnackedCommands.Commands.Num() && !GE_IsSequenceNewer(UnackedCommands.Commands[NumAcked].Sequence, AckedCommandSequence))
 	{
-		HandleShotFXAndRecoil();
+		++NumAcked;
 	}
-}
 
-void AGE_FireWeapon::OnRep_FireMode()
-{
-	FireMode = RepFireMode;
-	OnFireModeChanged.Broadcast(FireMode);
+	if (NumAcked > 0)
+	{
+		UnackedCommands.Commands.RemoveAt(0, NumAcked, EAllowShrinking::No);
+	}
+
+	if (UnackedCommands.Commands.Num() == 0)
+	{
+		GetWorldTimerManager().ClearTimer(TimerHandle_CommandResend);
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
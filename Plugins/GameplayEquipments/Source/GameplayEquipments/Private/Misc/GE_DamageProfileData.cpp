@@ -0,0 +1,132 @@
+#include "Misc/GE_DamageProfileData.h"
+
+#include "HAL/IConsoleManager.h"
+
+static void GE_BakeCurve(const FRuntimeFloatCurve& Curve, float MaxX, float* OutTable, int32 Size)
+{
+	const FRichCurve* Rich = Curve.GetRichCurveConst();
+	const bool bHasKeys = Rich && Rich->GetNumKeys() > 0;
+
+	for (int32 i = 0; i < Size; ++i)
+	{
+		const float X = MaxX * i / (Size - 1);
+		OutTable[i] = bHasKeys ? FMath::Max(0.f, Rich->Eval(X)) : 1.f;
+	}
+}
+
+FGE_DamageLUT::FGE_DamageLUT()
+{
+	for (float& Value : Range) { Value = 1.f; }
+	for (float& Value : Armor) { Value = 1.f; }
+	for (float& Value : Zones) { Value = 1.f; }
+}
+
+void FGE_DamageLUT::Bake(const FGE_DamageProfile& Profile)
+{
+	GE_BakeCurve(Profile.RangeFalloff, Profile.MaxRange, Range, RangeSize);
+	GE_BakeCurve(Profile.ArmorMitigation, Profile.MaxArmor, Armor, ArmorSize);
+
+	RangeToIndex = (RangeSize - 1) / FMath::Max(1.f, Profile.MaxRange);
+	ArmorToIndex = (ArmorSize - 1) / FMath::Max(1.f, Profile.MaxArmor);
+
+	Zones[static_cast<int32>(EGE_DamageZone::Generic)] = 1.f;
+	Zones[static_cast<int32>(EGE_DamageZone::Head)] = Profile.HeadMultiplier;
+	Zones[static_cast<int32>(EGE_DamageZone::Torso)] = Profile.TorsoMultiplier;
+	Zones[static_cast<int32>(EGE_DamageZone::Arms)] = Profile.ArmsMultiplier;
+	Zones[static_cast<int32>(EGE_DamageZone::Legs)] = Profile.LegsMultiplier;
+}
+
+void UGE_DamageProfileData::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	Bake();
+}
+
+void UGE_DamageProfileData::PostLoad()
+{
+	Super::PostLoad();
+
+	Bake();
+}
+
+#if WITH_EDITOR
+void UGE_DamageProfileData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	Bake();
+}
+#endif
+
+// Golden values
+
+static void GE_AddLinearKey(FRuntimeFloatCurve& Curve, float Time, float Value)
+{
+	FRichCurve& Rich = *Curve.GetRichCurve();
+	Rich.SetKeyInterpMode(Rich.AddKey(Time, Value), RCIM_Linear);
+}
+
+static void GE_DamageProfileSelfTest()
+{
+	// Full damage to 20 m, half from 60 m on. Armor linearly down to half at 100 points
+	FGE_DamageProfile Profile;
+	GE_AddLinearKey(Profile.RangeFalloff, 0.f, 1.f);
+	GE_AddLinearKey(Profile.RangeFalloff, 2000.f, 1.f);
+	GE_AddLinearKey(Profile.RangeFalloff, 6000.f, 0.5f);
+	Profile.MaxRange = 8000.f;
+	Profile.HeadMultiplier = 2.f;
+	Profile.TorsoMultiplier = 1.f;
+	Profile.ArmsMultiplier = 0.8f;
+	Profile.LegsMultiplier = 0.7f;
+	GE_AddLinearKey(Profile.ArmorMitigation, 0.f, 1.f);
+	GE_AddLinearKey(Profile.ArmorMitigation, 100.f, 0.5f);
+	Profile.MaxArmor = 100.f;
+
+	FGE_DamageLUT LUT;
+	LUT.Bake(Profile);
+
+	struct FGolden
+	{
+		float Distance;
+		EGE_DamageZone Zone;
+		float Armor;
+		float Expected;
+	};
+
+	// 20 base damage, sampled away from the falloff knees where the table is exact
+	static const FGolden Goldens[] = {
+		{ 1000.f, EGE_DamageZone::Torso, 0.f, 20.f },
+		{ 4000.f, EGE_DamageZone::Head, 0.f, 30.f },
+		{ 7000.f, EGE_DamageZone::Legs, 50.f, 5.25f },
+		{ 12000.f, EGE_DamageZone::Arms, 100.f, 4.f },
+		{ 0.f, EGE_DamageZone::Generic, 200.f, 10.f },
+	};
+
+	int32 NumFailed = 0;
+	for (const FGolden& Golden : Goldens)
+	{
+		const float Damage = 20.f * LUT.GetHitScale(Golden.Distance, Golden.Zone) * LUT.GetArmorScale(Golden.Armor);
+		if (!FMath::IsNearlyEqual(Damage, Golden.Expected, 1.e-3f))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Damage profile: %.0f cm, zone %d, %.0f armor gave %.4f, expected %.4f"),
+				Golden.Distance, static_cast<int32>(Golden.Zone), Golden.Armor, Damage, Golden.Expected);
+			++NumFailed;
+		}
+	}
+
+	// Worst table error against the curve itself, the knee at 20 m falls between samples
+	float MaxError = 0.f;
+	for (float Distance = 0.f; Distance <= Profile.MaxRange; Distance += 10.f)
+	{
+		MaxError = FMath::Max(MaxError, FMath::Abs(LUT.GetRangeScale(Distance) - Profile.RangeFalloff.GetRichCurveConst()->Eval(Distance)));
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Damage profile self test: %d of %d golden values passed, largest falloff table error %.4f"),
+		UE_ARRAY_COUNT(Goldens) - NumFailed, UE_ARRAY_COUNT(Goldens), MaxError);
+}
+
+static FAutoConsoleCommand CmdDamageProfileSelfTest(
+	TEXT("GE.DamageProfile.SelfTest"),
+	TEXT("Bakes a known damage profile and checks its tables against golden values."),
+	FConsoleCommandDelegate::CreateStatic(&GE_DamageProfileSelfTest));
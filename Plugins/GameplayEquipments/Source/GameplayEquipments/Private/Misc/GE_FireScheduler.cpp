@@ -0,0 +1,78 @@
+#include "Misc/GE_FireScheduler.h"
+
+#include "HAL/IConsoleManager.h"
+
+void FGE_FireScheduler::Start(double InStartTime, double InInterval)
+{
+	StartTime = InStartTime;
+	Interval = FMath::Max(InInterval, UE_KINDA_SMALL_NUMBER);
+	NextShot = 0;
+	bActive = true;
+}
+
+void FGE_FireScheduler::Stop()
+{
+	bActive = false;
+}
+
+int32 FGE_FireScheduler::Advance(double Now, FShotTimes& OutShotTimes)
+{
+	if (!bActive) return 0;
+
+	int32 NumShots = 0;
+
+	// Multiply instead of accumulating so error never builds up over a long burst
+	double ShotTime = StartTime + NextShot * Interval;
+	while (ShotTime <= Now)
+	{
+		OutShotTimes.Add(ShotTime);
+		++NumShots;
+
+		ShotTime = StartTime + ++NextShot * Interval;
+	}
+
+	return NumShots;
+}
+
+// Simulates 10 seconds of held fire at several tick rates and checks the shot count against the RPM.
+static void GE_FireSchedulerVerify(const TArray<FString>& Args)
+{
+	const double RPM = Args.Num() > 0 ? FCString::Atod(*Args[0]) : 2000.0;
+	const double Duration = 10.0;
+	const double Interval = 60.0 / RPM;
+
+	// Shots at k * Interval inside [0, Duration)
+	const int64 Expected = static_cast<int64>(FMath::CeilToDouble(Duration / Interval - UE_DOUBLE_KINDA_SMALL_NUMBER));
+
+	for (const double TickRate : { 20.0, 30.0, 60.0, 144.0 })
+	{
+		FGE_FireScheduler Scheduler;
+		Scheduler.Start(0.0, Interval);
+
+		int64 NumShots = 0;
+		double MaxError = 0.0;
+
+		const int64 NumTicks = static_cast<int64>(FMath::CeilToDouble(Duration * TickRate));
+		for (int64 Tick = 0; Tick <= NumTicks; ++Tick)
+		{
+			FGE_FireScheduler::FShotTimes ShotTimes;
+			Scheduler.Advance(Tick / TickRate, ShotTimes);
+
+			for (const double ShotTime : ShotTimes)
+			{
+				if (ShotTime >= Duration) continue;
+
+				MaxError = FMath::Max(MaxError, FMath::Abs(ShotTime - NumShots * Interval));
+				++NumShots;
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Fire scheduler %.0f RPM @ %.0f Hz: %lld shots, expected %lld, max timestamp error %.9f s [%s]"),
+			RPM, TickRate, NumShots, Expected, MaxError, NumShots == Expected ? TEXT("OK") : TEXT("FAILED"));
+	}
+}
+
+static FAutoConsoleCommand CmdFireSchedulerVerify(
+	TEXT("GE.FireScheduler.Verify"),
+	TEXT("Checks shot count over 10 seconds at 20, 30, 60 and 144 Hz.\nArgs: [RPM=2000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&GE_FireSchedulerVerify));
@@ -0,0 +1,197 @@
+#include "Misc/GE_PenetrationData.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/GE_Stats.h"
+#include "Equipments/GE_FireWeapon.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Penetration Probes"), STAT_GE_PenetrationProbes, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Penetrations"), STAT_GE_Penetrations, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ricochets"), STAT_GE_Ricochets, STATGROUP_GameplayEquipments);
+
+const FCollisionResponseParams& UGE_PenetrationData::GetEntryResponseParams()
+{
+	static const FCollisionResponseParams ResponseParams = []()
+	{
+		FCollisionResponseParams Params;
+		Params.CollisionResponse.SetAllChannels(ECR_Overlap);
+		return Params;
+	}();
+
+	return ResponseParams;
+}
+
+int32 UGE_PenetrationData::ResolvePellet(const UWorld* World, const FVector& Start, const FVector& End, ECollisionChannel Channel, const FCollisionQueryParams& Params,
+	TConstArrayView<FGE_ShotHit> Entries, TArray<FGE_ShotHit>& OutHits) const
+{
+	const FVector Dir = (End - Start).GetSafeNormal();
+	const double Length = FVector::Dist(Start, End);
+
+	TArray<FHitResult, TInlineAllocator<8>> Exits;
+	bool bProbeUsed = false;
+	float Scale = 1.0f;
+
+	for (const FGE_ShotHit& Entry : Entries)
+	{
+		if (Entry.Hit.bStartPenetrating) continue;
+
+		FGE_ShotHit& Out = OutHits.Add_GetRef(Entry);
+		Out.Hit.bBlockingHit = true;
+		Out.Hit.TraceEnd = End;
+		Out.DamageScale = Scale;
+
+		if (OutHits.Num() >= MaxSurfaces) break;
+
+		const FGE_SurfacePenetration& Surface = GetSurface(Entry.SurfaceType);
+		const FVector EntryPoint = Entry.Hit.ImpactPoint;
+
+		const double GrazingAngle = FMath::RadiansToDegrees(FMath::Asin(FMath::Min(1.0, FMath::Abs(Dir | FVector(Entry.Hit.ImpactNormal)))));
+		if (GrazingAngle <= Surface.RicochetAngle)
+		{
+			if (bProbeUsed) break;
+			bProbeUsed = true;
+
+			INC_DWORD_STAT(STAT_GE_Ricochets);
+
+			const FVector Bounce = FMath::GetReflectionVector(Dir, Entry.Hit.ImpactNormal);
+			const FVector BounceStart = EntryPoint + Bounce * 0.1;
+			const FVector BounceEnd = EntryPoint + Bounce * FMath::Max(0.0, Length - Entry.Hit.Distance);
+
+			FHitResult BounceHit;
+			if (World->LineTraceSingleByChannel(BounceHit, BounceStart, BounceEnd, Channel, Params))
+			{
+				FGE_ShotHit& Ricochet = OutHits.Add_GetRef(FGE_ShotHit::Resolve(BounceHit));
+				Ricochet.DamageScale = Scale * Surface.RicochetDamageRetention;
+				Ricochet.Range = Entry.Hit.Distance + BounceHit.Distance;
+			}
+			break;
+		}
+
+		if (Surface.PenetrationDepth <= 0.0f) break;
+
+		// One reverse trace from the end of the pellet finds the exit of every surface at once
+		if (!bProbeUsed)
+		{
+			bProbeUsed = true;
+
+			TArray<FHitResult> ReverseHits;
+			World->LineTraceMultiByChannel(ReverseHits, End, EntryPoint, Channel, Params, GetEntryResponseParams());
+			for (FHitResult& ReverseHit : ReverseHits)
+			{
+				if (!ReverseHit.bStartPenetrating)
+				{
+					Exits.Add(MoveTemp(ReverseHit));
+				}
+			}
+		}
+
+		// Nearest exit face of the same component past the entry, reverse hits are sorted from the end back
+		double Thickness = TNumericLimits<double>::Max();
+		for (int32 e = Exits.Num() - 1; e >= 0; --e)
+		{
+			const FHitResult& Exit = Exits[e];
+			if (Exit.Component != Entry.Hit.Component) continue;
+
+			const double ExitDistance = Length - Exit.Distance;
+			if (ExitDistance > Entry.Hit.Distance)
+			{
+				Thickness = ExitDistance - Entry.Hit.Distance;
+				break;
+			}
+		}
+
+		if (Thickness > Surface.PenetrationDepth) break;
+
+		INC_DWORD_STAT(STAT_GE_Penetrations);
+
+		Scale *= Surface.DamageRetention;
+		if (Scale <= UE_KINDA_SMALL_NUMBER) break;
+	}
+
+	if (bProbeUsed)
+	{
+		INC_DWORD_STAT(STAT_GE_PenetrationProbes);
+	}
+
+	return bProbeUsed ? 1 : 0;
+}
+
+// Benchmark
+
+static void GE_PenetrationBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 NumPellets = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 12;
+	const int32 NumShots = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+	const float Spread = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 3.0f;
+
+	const APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+	if (!PC)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Penetration benchmark needs a local player."));
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	// Everything penetrable and ricochet prone, so every pellet tries to spend its probe
+	UGE_PenetrationData* Data = NewObject<UGE_PenetrationData>(GetTransientPackage());
+	Data->Default.PenetrationDepth = 50.0f;
+	Data->Default.RicochetAngle = 15.0f;
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(PenetrationBenchmark), true, PC->GetPawn());
+	Params.bReturnPhysicalMaterial = true;
+	Params.bReturnFaceIndex = !UPhysicsSettings::Get()->bSuppressFaceRemapTable;
+
+	TArray<FVector> Directions;
+	TArray<FHitResult> Hits;
+	TArray<FGE_ShotHit> Entries;
+	TArray<FGE_ShotHit> OutHits;
+
+	int32 TotalQueries = 0;
+	int32 MaxQueriesPerShot = 0;
+	int32 TotalSurfaces = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 s = 0; s < NumShots; ++s)
+	{
+		FGE_BulletData::GeneratePelletDirections(ViewRotation, Spread, static_cast<uint16>(s), NumPellets, Directions);
+
+		int32 ShotQueries = 0;
+		for (const FVector& Direction : Directions)
+		{
+			const FVector End = ViewLocation + Direction * 20000.0;
+
+			Hits.Reset();
+			World->LineTraceMultiByChannel(Hits, ViewLocation, End, ECC_Visibility, Params, UGE_PenetrationData::GetEntryResponseParams());
+			++ShotQueries;
+
+			Entries.Reset();
+			for (const FHitResult& Hit : Hits)
+			{
+				Entries.Add(FGE_ShotHit::Resolve(Hit));
+			}
+
+			OutHits.Reset();
+			ShotQueries += Data->ResolvePellet(World, ViewLocation, End, ECC_Visibility, Params, Entries, OutHits);
+			TotalSurfaces += OutHits.Num();
+		}
+
+		TotalQueries += ShotQueries;
+		MaxQueriesPerShot = FMath::Max(MaxQueriesPerShot, ShotQueries);
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Display, TEXT("Penetration benchmark: %d shots of %d pellets. %.2f queries per shot, %d max (bound %d), %.2f surfaces per pellet. %.3f us per shot"),
+		NumShots, NumPellets, static_cast<double>(TotalQueries) / NumShots, MaxQueriesPerShot, NumPellets * 2,
+		static_cast<double>(TotalSurfaces) / (NumShots * NumPellets), Elapsed * 1.0e6 / NumShots);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdPenetrationBenchmark(
+	TEXT("GE.Penetration.Benchmark"),
+	TEXT("Fires shotgun pellets from the local view and reports scene queries per shot.\nArgs: [Pellets=12] [Shots=100] [SpreadDegrees=3]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&GE_PenetrationBenchmark));
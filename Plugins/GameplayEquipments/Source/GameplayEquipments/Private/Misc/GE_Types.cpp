@@ -1 +1,44 @@
 #include "Misc/GE_Types.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+#include "Interfaces/GE_CharacterInterface.h"
+
+FGE_ShotHit FGE_ShotHit::Resolve(const FHitResult& InHit)
+{
+	FGE_ShotHit Out;
+	Out.Hit = InHit;
+	Out.BoneName = InHit.BoneName;
+	Out.Range = InHit.Distance;
+
+	if (const UPhysicalMaterial* PhysMaterial = InHit.PhysMaterial.Get())
+	{
+		Out.SurfaceType = PhysMaterial->SurfaceType;
+	}
+
+	if (InHit.FaceIndex != INDEX_NONE)
+	{
+		if (const UPrimitiveComponent* Component = InHit.GetComponent())
+		{
+			int32 SectionIndex;
+			Out.FaceMaterial = Component->GetMaterialFromCollisionFaceIndex(InHit.FaceIndex, SectionIndex);
+		}
+	}
+
+	if (!InHit.BoneName.IsNone())
+	{
+		if (const USkinnedMeshComponent* Skinned = Cast<USkinnedMeshComponent>(InHit.GetComponent()))
+		{
+			Out.BoneIndex = Skinned->GetBoneIndex(InHit.BoneName);
+		}
+	}
+
+	if (const IGE_CharacterInterface* Character = Cast<IGE_CharacterInterface>(InHit.GetActor()))
+	{
+		Out.DamageZone = Character->GetDamageZoneForBone(InHit.BoneName);
+	}
+
+	return Out;
+}
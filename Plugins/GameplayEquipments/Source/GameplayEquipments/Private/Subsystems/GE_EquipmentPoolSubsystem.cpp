@@ -0,0 +1,150 @@
+#include "Subsystems/GE_EquipmentPoolSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/GE_Stats.h"
+#include "Equipments/GE_Equipment.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Equipment"), STAT_GE_PooledEquipment, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Equipment Pool Hits/min"), STAT_GE_EquipmentPoolHits, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Equipment Pool Misses/min"), STAT_GE_EquipmentPoolMisses, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Equipment Destroyed/min"), STAT_GE_EquipmentDestroyed, STATGROUP_GameplayEquipments);
+
+static TAutoConsoleVariable<int32> CVarEquipmentPoolMaxPerClass(
+	TEXT("GE.EquipmentPool.MaxPerClass"), 64,
+	TEXT("Parked actors kept per equipment class, releases past it are destroyed as before. 0 disables pooling."),
+	ECVF_Default);
+
+static void GE_EquipmentPoolReport(UWorld* World)
+{
+	const UGE_EquipmentPoolSubsystem* Pool = World ? World->GetSubsystem<UGE_EquipmentPoolSubsystem>() : nullptr;
+	if (!Pool)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("GE.EquipmentPool.Report: no pool in this world"));
+		return;
+	}
+
+	const FGE_EquipmentPoolCounters& Total = Pool->GetTotalCounters();
+	const FGE_EquipmentPoolCounters& PerMinute = Pool->GetCountersPerMinute();
+
+	UE_LOG(LogTemp, Log, TEXT("Equipment pool: %d parked. Per minute: %d hits, %d misses, %d destroyed. Total: %d hits, %d misses, %d destroyed"),
+		Pool->GetNumParked(), PerMinute.Hits, PerMinute.Misses, PerMinute.Destroyed, Total.Hits, Total.Misses, Total.Destroyed);
+}
+
+static FAutoConsoleCommandWithWorld CmdEquipmentPoolReport(
+	TEXT("GE.EquipmentPool.Report"),
+	TEXT("Prints equipment pool hits, misses and destroyed actors per minute."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&GE_EquipmentPoolReport));
+
+void UGE_EquipmentPoolSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_GE_PooledEquipment, GetNumParked());
+	Buckets.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UGE_EquipmentPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AGE_Equipment* UGE_EquipmentPoolSubsystem::AcquireOrSpawn(TSubclassOf<AGE_Equipment> Class, const FTransform& SpawnTransform, ACharacter* NewOwner)
+{
+	UWorld* World = GetWorld();
+	if (!Class || !World || World->GetNetMode() == NM_Client) return nullptr;
+
+	RollMinute();
+
+	if (FGE_EquipmentPoolBucket* Bucket = Buckets.Find(Class))
+	{
+		while (Bucket->Parked.Num() > 0)
+		{
+			AGE_Equipment* Equipment = Bucket->Parked.Pop(EAllowShrinking::No);
+			DEC_DWORD_STAT(STAT_GE_PooledEquipment);
+
+			if (!IsValid(Equipment)) continue;
+
+			++Total.Hits;
+			++CurrentMinute.Hits;
+
+			Equipment->SetActorTransform(SpawnTransform);
+			Equipment->SetOwningCharacter(NewOwner);
+			return Equipment;
+		}
+	}
+
+	++Total.Misses;
+	++CurrentMinute.Misses;
+
+	AGE_Equipment* Equipment = World->SpawnActorDeferred<AGE_Equipment>(Class, SpawnTransform, NewOwner, NewOwner, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Equipment) return nullptr;
+
+	Equipment->SetOwningCharacter(NewOwner);
+	Equipment->FinishSpawning(SpawnTransform);
+	return Equipment;
+}
+
+bool UGE_EquipmentPoolSubsystem::Release(AGE_Equipment* Equipment)
+{
+	if (!IsValid(Equipment) || !Equipment->HasAuthority()) return false;
+
+	RollMinute();
+
+	FGE_EquipmentPoolBucket& Bucket = Buckets.FindOrAdd(Equipment->GetClass());
+	if (Bucket.Parked.Num() >= CVarEquipmentPoolMaxPerClass.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	Equipment->ResetForPool();
+
+	Bucket.Parked.Add(Equipment);
+	INC_DWORD_STAT(STAT_GE_PooledEquipment);
+	return true;
+}
+
+void UGE_EquipmentPoolSubsystem::NotifyEquipmentDestroyed(AGE_Equipment* Equipment)
+{
+	RollMinute();
+
+	++Total.Destroyed;
+	++CurrentMinute.Destroyed;
+
+	if (FGE_EquipmentPoolBucket* Bucket = Buckets.Find(Equipment->GetClass()))
+	{
+		if (Bucket->Parked.RemoveSingleSwap(Equipment, EAllowShrinking::No) > 0)
+		{
+			DEC_DWORD_STAT(STAT_GE_PooledEquipment);
+		}
+	}
+}
+
+int32 UGE_EquipmentPoolSubsystem::GetNumParked() const
+{
+	int32 NumParked = 0;
+	for (const TPair<TSubclassOf<AGE_Equipment>, FGE_EquipmentPoolBucket>& Pair : Buckets)
+	{
+		NumParked += Pair.Value.Parked.Num();
+	}
+	return NumParked;
+}
+
+void UGE_EquipmentPoolSubsystem::RollMinute()
+{
+	const double Now = GetWorld()->GetRealTimeSeconds();
+	const double Elapsed = Now - MinuteStartTime;
+	if (Elapsed < 60.0) return;
+
+	// A quiet gap of more than a minute reads as a minute of nothing
+	LastMinute = Elapsed < 120.0 ? CurrentMinute : FGE_EquipmentPoolCounters();
+	CurrentMinute = FGE_EquipmentPoolCounters();
+	MinuteStartTime = Now;
+	bHasFullMinute = true;
+
+	SET_DWORD_STAT(STAT_GE_EquipmentPoolHits, LastMinute.Hits);
+	SET_DWORD_STAT(STAT_GE_EquipmentPoolMisses, LastMinute.Misses);
+	SET_DWORD_STAT(STAT_GE_EquipmentDestroyed, LastMinute.Destroyed);
+}
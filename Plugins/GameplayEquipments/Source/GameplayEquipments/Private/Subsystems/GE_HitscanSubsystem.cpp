@@ -0,0 +1,293 @@
+#include "Subsystems/GE_HitscanSubsystem.h"
+
+#include "Engine/World.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+#include "Misc/GE_Stats.h"
+#include "Misc/GE_PenetrationData.h"
+#include "Equipments/GE_FireWeapon.h"
+#include "Subsystems/GE_LagCompensationSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitscan Issue"), STAT_GE_HitscanIssue, STATGROUP_GameplayEquipments);
+DECLARE_CYCLE_STAT(TEXT("Hitscan Resolve"), STAT_GE_HitscanResolve, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Traces"), STAT_GE_HitscanTraces, STATGROUP_GameplayEquipments);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Hitscan Batch Latency (ms)"), STAT_GE_HitscanLatency, STATGROUP_GameplayEquipments);
+
+// FBatch
+
+void UGE_HitscanSubsystem::FBatch::Reserve(int32 Count)
+{
+	Weapons.Reserve(Count);
+	ShotSequences.Reserve(Count);
+	Starts.Reserve(Count);
+	Ends.Reserve(Count);
+	Channels.Reserve(Count);
+	RewindTimes.Reserve(Count);
+	QueueTimes.Reserve(Count);
+	Handles.Reserve(Count);
+}
+
+void UGE_HitscanSubsystem::FBatch::Reset()
+{
+	Weapons.Reset();
+	ShotSequences.Reset();
+	Starts.Reset();
+	Ends.Reset();
+	Channels.Reset();
+	RewindTimes.Reset();
+	QueueTimes.Reset();
+	Handles.Reset();
+}
+
+void UGE_HitscanSubsystem::FBatch::Move(int32 From, int32 To)
+{
+	Weapons[To] = MoveTemp(Weapons[From]);
+	ShotSequences[To] = ShotSequences[From];
+	Starts[To] = Starts[From];
+	Ends[To] = Ends[From];
+	Channels[To] = Channels[From];
+	RewindTimes[To] = RewindTimes[From];
+	QueueTimes[To] = QueueTimes[From];
+	Handles[To] = Handles[From];
+}
+
+void UGE_HitscanSubsystem::FBatch::Truncate(int32 Count)
+{
+	Weapons.SetNum(Count, EAllowShrinking::No);
+	ShotSequences.SetNum(Count, EAllowShrinking::No);
+	Starts.SetNum(Count, EAllowShrinking::No);
+	Ends.SetNum(Count, EAllowShrinking::No);
+	Channels.SetNum(Count, EAllowShrinking::No);
+	RewindTimes.SetNum(Count, EAllowShrinking::No);
+	QueueTimes.SetNum(Count, EAllowShrinking::No);
+	Handles.SetNum(Count, EAllowShrinking::No);
+}
+
+int32 UGE_HitscanSubsystem::FBatch::Append(const FBatch& Other, int32 Index)
+{
+	Weapons.Add(Other.Weapons[Index]);
+	ShotSequences.Add(Other.ShotSequences[Index]);
+	Starts.Add(Other.Starts[Index]);
+	Ends.Add(Other.Ends[Index]);
+	Channels.Add(Other.Channels[Index]);
+	RewindTimes.Add(Other.RewindTimes[Index]);
+	QueueTimes.Add(Other.QueueTimes[Index]);
+	return Handles.Add(Other.Handles[Index]);
+}
+
+static FCollisionQueryParams GE_MakeWeaponQueryParams(const AGE_FireWeapon* Weapon, bool bRewind, const UGE_LagCompensationSubsystem* LagCompensation, bool bReturnFaceIndex)
+{
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponTrace), true, Weapon->GetOwner());
+	Params.bReturnPhysicalMaterial = true;
+	Params.bReturnFaceIndex = bReturnFaceIndex;
+
+	// Characters are resolved against their rewound hitboxes once the world result is back
+	if (LagCompensation && bRewind)
+	{
+		LagCompensation->AddTrackedActorsToQuery(Params);
+	}
+
+	return Params;
+}
+
+// UGE_HitscanSubsystem
+
+void UGE_HitscanSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Pending.Reserve(256);
+	InFlight.Reserve(256);
+}
+
+void UGE_HitscanSubsystem::Deinitialize()
+{
+	Pending.Reset();
+	InFlight.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UGE_HitscanSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGE_HitscanSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Last frame's batch first, so damage lands one frame after the shot at most
+	ResolveInFlight();
+	IssuePending();
+}
+
+TStatId UGE_HitscanSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGE_HitscanSubsystem, STATGROUP_Tickables);
+}
+
+void UGE_HitscanSubsystem::QueueTrace(AGE_FireWeapon* Weapon, uint16 ShotSequence, const FVector& Start, const FVector& End, ECollisionChannel Channel, double RewindTimestamp)
+{
+	if (!IsValid(Weapon)) return;
+
+	Pending.Weapons.Add(Weapon);
+	Pending.ShotSequences.Add(ShotSequence);
+	Pending.Starts.Add(Start);
+	Pending.Ends.Add(End);
+	Pending.Channels.Add(Channel);
+	Pending.RewindTimes.Add(RewindTimestamp);
+	Pending.QueueTimes.Add(FPlatformTime::Seconds());
+	Pending.Handles.AddDefaulted();
+}
+
+void UGE_HitscanSubsystem::IssuePending()
+{
+	if (Pending.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_HitscanIssue);
+
+	UWorld* World = GetWorld();
+	const UGE_LagCompensationSubsystem* LagCompensation = World->GetSubsystem<UGE_LagCompensationSubsystem>();
+	const bool bReturnFaceIndex = !UPhysicsSettings::Get()->bSuppressFaceRemapTable;
+
+	for (int32 i = 0; i < Pending.Num(); ++i)
+	{
+		const AGE_FireWeapon* Weapon = Pending.Weapons[i].Get();
+		if (!Weapon) continue;
+
+		const FCollisionQueryParams Params = GE_MakeWeaponQueryParams(Weapon, Pending.RewindTimes[i] >= 0.0, LagCompensation, bReturnFaceIndex);
+
+		// Penetrating weapons need every entry along the pellet, not just the first blocking one
+		if (Weapon->PenetrationData)
+		{
+			Pending.Handles[i] = World->AsyncLineTraceByChannel(EAsyncTraceType::Multi, Pending.Starts[i], Pending.Ends[i], Pending.Channels[i], Params, UGE_PenetrationData::GetEntryResponseParams());
+		}
+		else
+		{
+			Pending.Handles[i] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Pending.Starts[i], Pending.Ends[i], Pending.Channels[i], Params);
+		}
+		InFlight.Append(Pending, i);
+	}
+
+	INC_DWORD_STAT_BY(STAT_GE_HitscanTraces, Pending.Num());
+
+	Pending.Reset();
+}
+
+void UGE_HitscanSubsystem::ResolveInFlight()
+{
+	if (InFlight.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_HitscanResolve);
+
+	UWorld* World = GetWorld();
+	const UGE_LagCompensationSubsystem* LagCompensation = World->GetSubsystem<UGE_LagCompensationSubsystem>();
+
+	const double Now = FPlatformTime::Seconds();
+	double MaxLatency = 0.0;
+
+	// Walk in queue order so hits resolve in the order they were fired, unfinished traces are compacted to the front
+	int32 NumKept = 0;
+	for (int32 i = 0; i < InFlight.Num(); ++i)
+	{
+		const FTraceHandle& Handle = InFlight.Handles[i];
+
+		FTraceDatum Datum;
+		if (!World->QueryTraceData(Handle, Datum))
+		{
+			if (World->IsTraceHandleValid(Handle, false))
+			{
+				if (NumKept != i)
+				{
+					InFlight.Move(i, NumKept);
+				}
+				++NumKept;
+			}
+			continue;
+		}
+
+		MaxLatency = FMath::Max(MaxLatency, Now - InFlight.QueueTimes[i]);
+
+		AGE_FireWeapon* Weapon = InFlight.Weapons[i].Get();
+		if (!Weapon) continue;
+
+		const FVector& Start = InFlight.Starts[i];
+		const FVector& End = InFlight.Ends[i];
+
+		if (Weapon->PenetrationData)
+		{
+			ResolvePenetration(Weapon, i, Datum);
+			continue;
+		}
+
+		FGE_ShotHit ShotHit = FGE_ShotHit::Resolve(Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult(Start, End));
+
+		if (LagCompensation && InFlight.RewindTimes[i] >= 0.0)
+		{
+			const FVector RewindEnd = ShotHit.Hit.bBlockingHit ? FVector(ShotHit.Hit.Location) : End;
+
+			FGE_ShotHit RewoundHit;
+			if (LagCompensation->TraceRewound(Start, RewindEnd, InFlight.RewindTimes[i], Weapon->GetOwner(), RewoundHit))
+			{
+				RewoundHit.Hit.TraceEnd = End;
+				ShotHit = MoveTemp(RewoundHit);
+			}
+		}
+
+		Weapon->HandleShotHit(ShotHit, InFlight.ShotSequences[i]);
+		DamagedWeapons.AddUnique(Weapon);
+	}
+
+	InFlight.Truncate(NumKept);
+
+	// Pellets of one shot finish in the same pass, so each victim takes each shot as one event
+	for (const TWeakObjectPtr<AGE_FireWeapon>& Weapon : DamagedWeapons)
+	{
+		if (Weapon.IsValid())
+		{
+			Weapon->ApplyPendingShotDamage();
+		}
+	}
+	DamagedWeapons.Reset();
+
+	SET_FLOAT_STAT(STAT_GE_HitscanLatency, static_cast<float>(MaxLatency * 1000.0));
+}
+
+void UGE_HitscanSubsystem::ResolvePenetration(AGE_FireWeapon* Weapon, int32 Index, const FTraceDatum& Datum)
+{
+	UWorld* World = GetWorld();
+	const UGE_LagCompensationSubsystem* LagCompensation = World->GetSubsystem<UGE_LagCompensationSubsystem>();
+
+	const FVector& Start = InFlight.Starts[Index];
+	const FVector& End = InFlight.Ends[Index];
+	const double RewindTime = InFlight.RewindTimes[Index];
+
+	Entries.Reset();
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		Entries.Add(FGE_ShotHit::Resolve(Hit));
+	}
+
+	// Rewound characters were ignored by the world query, slot the hitbox hit in by distance
+	FGE_ShotHit RewoundHit;
+	if (LagCompensation && RewindTime >= 0.0 && LagCompensation->TraceRewound(Start, End, RewindTime, Weapon->GetOwner(), RewoundHit))
+	{
+		const int32 InsertIndex = Entries.IndexOfByPredicate([&RewoundHit](const FGE_ShotHit& Entry)
+		{
+			return Entry.Hit.Distance > RewoundHit.Hit.Distance;
+		});
+		Entries.Insert(MoveTemp(RewoundHit), InsertIndex == INDEX_NONE ? Entries.Num() : InsertIndex);
+	}
+
+	const FCollisionQueryParams Params = GE_MakeWeaponQueryParams(Weapon, RewindTime >= 0.0, LagCompensation, !UPhysicsSettings::Get()->bSuppressFaceRemapTable);
+
+	Hits.Reset();
+	Weapon->PenetrationData->ResolvePellet(World, Start, End, InFlight.Channels[Index], Params, Entries, Hits);
+
+	for (const FGE_ShotHit& Hit : Hits)
+	{
+		Weapon->HandleShotHit(Hit, InFlight.ShotSequences[Index]);
+	}
+	DamagedWeapons.AddUnique(Weapon);
+}
@@ -0,0 +1,413 @@
+#include "Subsystems/GE_ImpactFXSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/DecalComponent.h"
+#include "Components/AudioComponent.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/GE_Stats.h"
+#include "Misc/GE_ImpactFXData.h"
+
+DECLARE_CYCLE_STAT(TEXT("ImpactFX Spawn"), STAT_GE_ImpactFXSpawn, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImpactFX Spawned"), STAT_GE_ImpactFXSpawned, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImpactFX Culled"), STAT_GE_ImpactFXCulled, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImpactFX Over Budget"), STAT_GE_ImpactFXOverBudget, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImpactFX Recycled"), STAT_GE_ImpactFXRecycled, STATGROUP_GameplayEquipments);
+
+static TAutoConsoleVariable<int32> CVarImpactFXMaxEffectsPerFrame(
+	TEXT("GE.ImpactFX.MaxEffectsPerFrame"), 8,
+	TEXT("Niagara impacts started per frame, the rest are skipped."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarImpactFXMaxDecalsPerFrame(
+	TEXT("GE.ImpactFX.MaxDecalsPerFrame"), 8,
+	TEXT("Impact decals placed per frame, the rest are skipped."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarImpactFXMaxSoundsPerFrame(
+	TEXT("GE.ImpactFX.MaxSoundsPerFrame"), 4,
+	TEXT("Impact sounds started per frame, the rest are skipped."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarImpactFXCullDistance(
+	TEXT("GE.ImpactFX.CullDistance"), 6000.f,
+	TEXT("Impacts further than this from the local view are not spawned."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarImpactFXDecalPoolSize(
+	TEXT("GE.ImpactFX.DecalPoolSize"), 64,
+	TEXT("Impact decals allocated on warm up."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarImpactFXSoundPoolSize(
+	TEXT("GE.ImpactFX.SoundPoolSize"), 16,
+	TEXT("Impact audio components allocated on warm up."),
+	ECVF_Default);
+
+bool UGE_ImpactFXSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGE_ImpactFXSubsystem::Deinitialize()
+{
+	EffectPools.Empty();
+	Decals.Empty();
+	Sounds.Empty();
+
+	if (IsValid(PoolOwner))
+	{
+		PoolOwner->Destroy();
+	}
+	PoolOwner = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UGE_ImpactFXSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGE_ImpactFXSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	EffectsThisFrame = 0;
+	DecalsThisFrame = 0;
+	SoundsThisFrame = 0;
+
+	RefreshView();
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (int32 i = 0; i < Decals.Num(); ++i)
+	{
+		if (DecalExpireTimes[i] > 0.0 && DecalExpireTimes[i] <= Now)
+		{
+			DecalExpireTimes[i] = 0.0;
+			Decals[i]->SetVisibility(false);
+		}
+	}
+}
+
+TStatId UGE_ImpactFXSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGE_ImpactFXSubsystem, STATGROUP_Tickables);
+}
+
+void UGE_ImpactFXSubsystem::Prewarm(const UGE_ImpactFXData* Data)
+{
+	if (!Data) return;
+
+	EnsurePoolOwner();
+	if (!PoolOwner) return;
+
+	if (Decals.Num() == 0)
+	{
+		const int32 NumDecals = FMath::Max(1, CVarImpactFXDecalPoolSize.GetValueOnGameThread());
+		Decals.Reserve(NumDecals);
+		for (int32 i = 0; i < NumDecals; ++i)
+		{
+			UDecalComponent* Decal = NewObject<UDecalComponent>(PoolOwner);
+			Decal->SetVisibility(false);
+			Decal->RegisterComponent();
+			Decals.Add(Decal);
+		}
+		DecalLastUsed.Init(0.0, NumDecals);
+		DecalExpireTimes.Init(0.0, NumDecals);
+	}
+
+	if (Sounds.Num() == 0)
+	{
+		const int32 NumSounds = FMath::Max(1, CVarImpactFXSoundPoolSize.GetValueOnGameThread());
+		Sounds.Reserve(NumSounds);
+		for (int32 i = 0; i < NumSounds; ++i)
+		{
+			UAudioComponent* Sound = NewObject<UAudioComponent>(PoolOwner);
+			Sound->bAutoActivate = false;
+			Sound->bAutoDestroy = false;
+			Sound->RegisterComponent();
+			Sounds.Add(Sound);
+		}
+		SoundLastUsed.Init(0.0, NumSounds);
+	}
+
+	EnsureEffectPool(Data->GetImpactFX(SurfaceType_Default).Effect, Data->EffectsPerSurface);
+	for (const TPair<TEnumAsByte<EPhysicalSurface>, FGE_ImpactFX>& Pair : Data->Surfaces)
+	{
+		EnsureEffectPool(Pair.Value.Effect, Data->EffectsPerSurface);
+	}
+}
+
+bool UGE_ImpactFXSubsystem::SpawnImpact(const UGE_ImpactFXData* Data, const FGE_ShotHit& ShotHit)
+{
+	if (!Data || !ShotHit.IsValidBlockingHit()) return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_ImpactFXSpawn);
+
+	const FVector Location = ShotHit.Hit.ImpactPoint;
+
+	// Sounds are heard behind the camera, visuals need to be in the frustum
+	const bool bAudible = IsInView(Location, false);
+	const bool bVisible = bAudible && IsInView(Location, true);
+	if (!bAudible)
+	{
+		INC_DWORD_STAT(STAT_GE_ImpactFXCulled);
+		return false;
+	}
+
+	// Cold path, only until the weapon prewarms this data
+	if (Decals.Num() == 0)
+	{
+		Prewarm(Data);
+	}
+
+	const FGE_ImpactFX& FX = Data->GetImpactFX(ShotHit.SurfaceType);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const FRotator Rotation = ShotHit.Hit.ImpactNormal.Rotation();
+
+	bool bSpawned = false;
+
+	if (bVisible && FX.Effect)
+	{
+		if (EffectsThisFrame < CVarImpactFXMaxEffectsPerFrame.GetValueOnGameThread())
+		{
+			if (UNiagaraComponent* Effect = AcquireEffect(FX.Effect, Data->EffectsPerSurface, Now))
+			{
+				Effect->SetWorldLocationAndRotation(Location, Rotation);
+				Effect->Activate(true);
+
+				++EffectsThisFrame;
+				bSpawned = true;
+			}
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_GE_ImpactFXOverBudget);
+		}
+	}
+
+	if (bVisible && FX.DecalMaterial && FX.DecalLifetime > 0.f)
+	{
+		if (DecalsThisFrame < CVarImpactFXMaxDecalsPerFrame.GetValueOnGameThread())
+		{
+			const int32 Index = AcquireDecal(Now);
+			if (Index != INDEX_NONE)
+			{
+				UDecalComponent* Decal = Decals[Index];
+				DecalExpireTimes[Index] = Now + FX.DecalLifetime;
+
+				FRotator DecalRotation = (-ShotHit.Hit.ImpactNormal).Rotation();
+				DecalRotation.Roll = FMath::FRandRange(-180.f, 180.f);
+
+				Decal->SetDecalMaterial(FX.DecalMaterial);
+				Decal->DecalSize = FX.DecalSize;
+				Decal->SetWorldLocationAndRotation(Location, DecalRotation);
+				Decal->SetVisibility(true);
+				Decal->MarkRenderStateDirty();
+
+				++DecalsThisFrame;
+				bSpawned = true;
+			}
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_GE_ImpactFXOverBudget);
+		}
+	}
+
+	if (FX.Sound)
+	{
+		if (SoundsThisFrame < CVarImpactFXMaxSoundsPerFrame.GetValueOnGameThread())
+		{
+			if (UAudioComponent* Sound = AcquireSound(Now))
+			{
+				Sound->SetSound(FX.Sound);
+				Sound->SetWorldLocation(Location);
+				Sound->Play();
+
+				++SoundsThisFrame;
+				bSpawned = true;
+			}
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_GE_ImpactFXOverBudget);
+		}
+	}
+
+	if (bSpawned)
+	{
+		INC_DWORD_STAT(STAT_GE_ImpactFXSpawned);
+	}
+
+	return bSpawned;
+}
+
+void UGE_ImpactFXSubsystem::RefreshView()
+{
+	bHasView = false;
+
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	const APlayerCameraManager* Camera = PC ? PC->PlayerCameraManager.Get() : nullptr;
+	if (!Camera) return;
+
+	ViewLocation = Camera->GetCameraLocation();
+	ViewDirection = Camera->GetCameraRotation().Vector();
+
+	// Widened a little so impacts at the screen edge still show
+	const float HalfFOV = FMath::Min(Camera->GetFOVAngle() * 0.5f + 15.f, 180.f);
+	ViewCosHalfFOV = FMath::Cos(FMath::DegreesToRadians(HalfFOV));
+
+	bHasView = true;
+}
+
+bool UGE_ImpactFXSubsystem::IsShotInRange(const FVector& Start, const FVector& End) const
+{
+	if (!bHasView) return true;
+
+	return FMath::PointDistToSegmentSquared(ViewLocation, Start, End) <= FMath::Square(CVarImpactFXCullDistance.GetValueOnGameThread());
+}
+
+bool UGE_ImpactFXSubsystem::IsInView(const FVector& Location, bool bRequireFrustum) const
+{
+	if (!bHasView) return true;
+
+	const FVector ToLocation = Location - ViewLocation;
+	const double DistSq = ToLocation.SizeSquared();
+	if (DistSq > FMath::Square(CVarImpactFXCullDistance.GetValueOnGameThread())) return false;
+
+	if (!bRequireFrustum || DistSq < FMath::Square(100.0)) return true;
+
+	return FVector::DotProduct(ToLocation, ViewDirection) >= ViewCosHalfFOV * FMath::Sqrt(DistSq);
+}
+
+int32 UGE_ImpactFXSubsystem::FindLeastRecentlyUsed(const TArray<double>& LastUsed)
+{
+	int32 Best = INDEX_NONE;
+	double BestTime = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < LastUsed.Num(); ++i)
+	{
+		if (LastUsed[i] < BestTime)
+		{
+			BestTime = LastUsed[i];
+			Best = i;
+		}
+	}
+	return Best;
+}
+
+UNiagaraComponent* UGE_ImpactFXSubsystem::AcquireEffect(UNiagaraSystem* System, int32 PoolSize, double Now)
+{
+	FGE_ImpactEffectPool* Pool = EffectPools.Find(System);
+	if (!Pool)
+	{
+		EnsureEffectPool(System, PoolSize);
+		Pool = EffectPools.Find(System);
+		if (!Pool) return nullptr;
+	}
+
+	// Idle components first, otherwise recycle the oldest
+	int32 Index = INDEX_NONE;
+	for (int32 i = 0; i < Pool->Components.Num(); ++i)
+	{
+		if (!Pool->Components[i]->IsActive())
+		{
+			Index = i;
+			break;
+		}
+	}
+
+	if (Index == INDEX_NONE)
+	{
+		Index = FindLeastRecentlyUsed(Pool->LastUsed);
+		INC_DWORD_STAT(STAT_GE_ImpactFXRecycled);
+	}
+
+	if (Index == INDEX_NONE) return nullptr;
+
+	Pool->LastUsed[Index] = Now;
+	return Pool->Components[Index];
+}
+
+int32 UGE_ImpactFXSubsystem::AcquireDecal(double Now)
+{
+	// Expired decals have the oldest use time, so LRU also picks those first
+	const int32 Index = FindLeastRecentlyUsed(DecalLastUsed);
+	if (Index == INDEX_NONE) return INDEX_NONE;
+
+	if (DecalExpireTimes[Index] > Now)
+	{
+		INC_DWORD_STAT(STAT_GE_ImpactFXRecycled);
+	}
+
+	DecalLastUsed[Index] = Now;
+	return Index;
+}
+
+UAudioComponent* UGE_ImpactFXSubsystem::AcquireSound(double Now)
+{
+	int32 Index = INDEX_NONE;
+	for (int32 i = 0; i < Sounds.Num(); ++i)
+	{
+		if (!Sounds[i]->IsPlaying())
+		{
+			Index = i;
+			break;
+		}
+	}
+
+	if (Index == INDEX_NONE)
+	{
+		Index = FindLeastRecentlyUsed(SoundLastUsed);
+		INC_DWORD_STAT(STAT_GE_ImpactFXRecycled);
+	}
+
+	if (Index == INDEX_NONE) return nullptr;
+
+	SoundLastUsed[Index] = Now;
+	return Sounds[Index];
+}
+
+void UGE_ImpactFXSubsystem::EnsurePoolOwner()
+{
+	if (IsValid(PoolOwner)) return;
+
+	FActorSpawnParameters Params;
+	Params.ObjectFlags |= RF_Transient;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	PoolOwner = GetWorld()->SpawnActor<AActor>(Params);
+}
+
+void UGE_ImpactFXSubsystem::EnsureEffectPool(UNiagaraSystem* System, int32 PoolSize)
+{
+	if (!System) return;
+
+	// Data sharing a system share its pool, sized for the largest of them
+	const int32 NumEffects = FMath::Max(1, PoolSize);
+	FGE_ImpactEffectPool* Existing = EffectPools.Find(System);
+	if (Existing && Existing->Components.Num() >= NumEffects) return;
+
+	EnsurePoolOwner();
+	if (!PoolOwner) return;
+
+	FGE_ImpactEffectPool& Pool = Existing ? *Existing : EffectPools.Add(System);
+
+	Pool.Components.Reserve(NumEffects);
+	while (Pool.Components.Num() < NumEffects)
+	{
+		UNiagaraComponent* Effect = NewObject<UNiagaraComponent>(PoolOwner);
+		Effect->SetAutoActivate(false);
+		Effect->SetAutoDestroy(false);
+		Effect->SetAsset(System);
+		Effect->RegisterComponent();
+		Pool.Components.Add(Effect);
+	}
+	Pool.LastUsed.SetNumZeroed(NumEffects);
+}
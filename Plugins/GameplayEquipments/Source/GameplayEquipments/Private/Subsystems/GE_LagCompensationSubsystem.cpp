@@ -0,0 +1,633 @@
+#include "Subsystems/GE_LagCompensationSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/GE_Stats.h"
+#include "Interfaces/GE_CharacterInterface.h"
+
+DECLARE_CYCLE_STAT(TEXT("LagCompensation Record"), STAT_GE_LagCompensationRecord, STATGROUP_GameplayEquipments);
+DECLARE_CYCLE_STAT(TEXT("LagCompensation Rewind"), STAT_GE_LagCompensationRewind, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("LagCompensation Tracked"), STAT_GE_LagCompensationTracked, STATGROUP_GameplayEquipments);
+
+static TAutoConsoleVariable<int32> CVarLagCompensationHistoryFrames(
+	TEXT("GE.LagCompensation.HistoryFrames"),
+	64,
+	TEXT("Hitbox frames kept per character. Applied when a character registers."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLagCompensationMaxRewind(
+	TEXT("GE.LagCompensation.MaxRewind"),
+	0.4f,
+	TEXT("Maximum time in seconds a shot is allowed to rewind."),
+	ECVF_Default);
+
+// FGE_HitboxShape
+
+float FGE_HitboxShape::GetBoundingRadius() const
+{
+	switch (Type)
+	{
+		case EGE_HitboxShapeType::Capsule: return Extent.X + Extent.Z;
+		case EGE_HitboxShapeType::Box:     return Extent.Size();
+		default:                           return Extent.X;
+	}
+}
+
+// FGE_HitboxHistory
+
+void FGE_HitboxHistory::Init(TArray<FGE_HitboxShape>&& InShapes, int32 InCapacity)
+{
+	Shapes = MoveTemp(InShapes);
+	Capacity = FMath::Max(2, InCapacity);
+
+	Samples.SetNumZeroed(Capacity * Shapes.Num());
+	Times.SetNumZeroed(Capacity);
+	Bounds.SetNumZeroed(Capacity);
+
+	Reset();
+}
+
+void FGE_HitboxHistory::Reset()
+{
+	Head = INDEX_NONE;
+	NumFrames = 0;
+}
+
+void FGE_HitboxHistory::Record(double Time, TFunctionRef<FTransform(int32)> GetBoneWorldTransform)
+{
+	if (Capacity <= 0 || Shapes.Num() == 0) return;
+
+	Head = (Head + 1) % Capacity;
+	NumFrames = FMath::Min(NumFrames + 1, Capacity);
+	Times[Head] = Time;
+
+	FGE_HitboxSample* Frame = &Samples[Head * Shapes.Num()];
+
+	FVector3f Center = FVector3f::ZeroVector;
+	for (int32 i = 0; i < Shapes.Num(); ++i)
+	{
+		const FTransform World = Shapes[i].LocalTransform * GetBoneWorldTransform(Shapes[i].BoneIndex);
+		Frame[i].Location = FVector3f(World.GetLocation());
+		Frame[i].Rotation = FQuat4f(World.GetRotation());
+		Center += Frame[i].Location;
+	}
+	Center /= static_cast<float>(Shapes.Num());
+
+	float Radius = 0.f;
+	for (int32 i = 0; i < Shapes.Num(); ++i)
+	{
+		Radius = FMath::Max(Radius, FVector3f::Dist(Center, Frame[i].Location) + Shapes[i].GetBoundingRadius());
+	}
+
+	Bounds[Head] = FVector4f(Center, Radius);
+}
+
+double FGE_HitboxHistory::GetNewestTime() const
+{
+	return NumFrames > 0 ? Times[GetSlot(0)] : 0.0;
+}
+
+double FGE_HitboxHistory::GetOldestTime() const
+{
+	return NumFrames > 0 ? Times[GetSlot(NumFrames - 1)] : 0.0;
+}
+
+void FGE_HitboxHistory::FindFrames(double Time, int32& OutSlotA, int32& OutSlotB, float& OutAlpha) const
+{
+	OutAlpha = 0.f;
+
+	if (Time >= Times[GetSlot(0)])
+	{
+		OutSlotA = OutSlotB = GetSlot(0);
+		return;
+	}
+
+	if (Time <= Times[GetSlot(NumFrames - 1)])
+	{
+		OutSlotA = OutSlotB = GetSlot(NumFrames - 1);
+		return;
+	}
+
+	// Youngest frame not newer than Time. Age 0 is newer than Time, the oldest age is not.
+	int32 Lo = 1;
+	int32 Hi = NumFrames - 1;
+	while (Lo < Hi)
+	{
+		const int32 Mid = (Lo + Hi) / 2;
+		if (Times[GetSlot(Mid)] <= Time) { Hi = Mid; }
+		else { Lo = Mid + 1; }
+	}
+
+	OutSlotA = GetSlot(Lo);
+	OutSlotB = GetSlot(Lo - 1);
+
+	const double Span = Times[OutSlotB] - Times[OutSlotA];
+	OutAlpha = Span > UE_DOUBLE_KINDA_SMALL_NUMBER ? static_cast<float>((Time - Times[OutSlotA]) / Span) : 0.f;
+}
+
+bool FGE_HitboxHistory::Raycast(const FVector& Start, const FVector& Dir, float MaxDistance, double Time, FGE_HitboxRaycastResult& OutResult) const
+{
+	if (NumFrames == 0) return false;
+
+	int32 SlotA, SlotB;
+	float Alpha;
+	FindFrames(Time, SlotA, SlotB, Alpha);
+
+	// Broad phase against the interpolated bounding sphere
+	{
+		const FVector4f& BA = Bounds[SlotA];
+		const FVector4f& BB = Bounds[SlotB];
+		const FVector Center = FVector(FMath::Lerp(FVector3f(BA), FVector3f(BB), Alpha));
+		const float Radius = FMath::Max(BA.W, BB.W);
+
+		const FVector ToCenter = Center - Start;
+		const double Along = FVector::DotProduct(ToCenter, Dir);
+		if (Along < -Radius || Along > MaxDistance + Radius) return false;
+		if ((ToCenter - Dir * Along).SizeSquared() > FMath::Square(Radius)) return false;
+	}
+
+	const FGE_HitboxSample* FrameA = &Samples[SlotA * Shapes.Num()];
+	const FGE_HitboxSample* FrameB = &Samples[SlotB * Shapes.Num()];
+
+	bool bHit = false;
+	float BestDistance = MaxDistance;
+
+	for (int32 i = 0; i < Shapes.Num(); ++i)
+	{
+		const FVector Location = FVector(FMath::Lerp(FrameA[i].Location, FrameB[i].Location, Alpha));
+		const FQuat Rotation = FQuat(FQuat4f::FastLerp(FrameA[i].Rotation, FrameB[i].Rotation, Alpha).GetNormalized());
+
+		float Distance;
+		FVector Normal;
+		if (RaycastShape(Shapes[i], Location, Rotation, Start, Dir, Distance, Normal) && Distance <= BestDistance)
+		{
+			bHit = true;
+			BestDistance = Distance;
+			OutResult.Distance = Distance;
+			OutResult.ShapeIndex = i;
+			OutResult.Normal = Normal;
+		}
+	}
+
+	return bHit;
+}
+
+bool FGE_HitboxHistory::RaycastShape(const FGE_HitboxShape& Shape, const FVector& Location, const FQuat& Rotation, const FVector& Start, const FVector& Dir, float& OutDistance, FVector& OutNormal)
+{
+	switch (Shape.Type)
+	{
+		case EGE_HitboxShapeType::Sphere:
+		{
+			const FVector OC = Start - Location;
+			const double B = FVector::DotProduct(OC, Dir);
+			const double C = OC.SizeSquared() - FMath::Square(Shape.Extent.X);
+			const double H = B * B - C;
+			if (H < 0.0) return false;
+
+			const double Sqrt = FMath::Sqrt(H);
+			if (-B + Sqrt < 0.0) return false;
+
+			OutDistance = static_cast<float>(FMath::Max(0.0, -B - Sqrt));
+			OutNormal = (Start + Dir * OutDistance - Location).GetSafeNormal();
+			return true;
+		}
+
+		case EGE_HitboxShapeType::Capsule:
+		{
+			const FVector Axis = Rotation.GetAxisZ() * Shape.Extent.Z;
+			const FVector PA = Location - Axis;
+			const FVector BA = Axis * 2.0;
+			const FVector OA = Start - PA;
+
+			const double BABA = FVector::DotProduct(BA, BA);
+			const double BARD = FVector::DotProduct(BA, Dir);
+			const double BAOA = FVector::DotProduct(BA, OA);
+			const double RDOA = FVector::DotProduct(Dir, OA);
+			const double OAOA = FVector::DotProduct(OA, OA);
+			const double R2 = FMath::Square(Shape.Extent.X);
+
+			double T = -1.0;
+
+			const double A = BABA - BARD * BARD;
+			const double B = BABA * RDOA - BAOA * BARD;
+			const double C = BABA * OAOA - BAOA * BAOA - R2 * BABA;
+			const double H = B * B - A * C;
+
+			if (A > UE_DOUBLE_SMALL_NUMBER && H >= 0.0)
+			{
+				const double BodyT = (-B - FMath::Sqrt(H)) / A;
+				const double Y = BAOA + BodyT * BARD;
+				if (Y > 0.0 && Y < BABA && BodyT >= 0.0)
+				{
+					T = BodyT;
+				}
+			}
+
+			if (T < 0.0)
+			{
+				// Caps
+				for (const FVector& CapCenter : { PA, PA + BA })
+				{
+					const FVector OC = Start - CapCenter;
+					const double CB = FVector::DotProduct(OC, Dir);
+					const double CH = CB * CB - (OC.SizeSquared() - R2);
+					if (CH < 0.0) continue;
+
+					const double CapT = -CB - FMath::Sqrt(CH);
+					if (CapT >= 0.0 && (T < 0.0 || CapT < T))
+					{
+						T = CapT;
+					}
+				}
+			}
+
+			if (T < 0.0) return false;
+
+			const FVector HitPoint = Start + Dir * T;
+			const double Segment = BABA > UE_DOUBLE_SMALL_NUMBER ? FMath::Clamp(FVector::DotProduct(HitPoint - PA, BA) / BABA, 0.0, 1.0) : 0.0;
+
+			OutDistance = static_cast<float>(T);
+			OutNormal = (HitPoint - (PA + BA * Segment)).GetSafeNormal();
+			return true;
+		}
+
+		case EGE_HitboxShapeType::Box:
+		{
+			const FVector LocalStart = Rotation.UnrotateVector(Start - Location);
+			const FVector LocalDir = Rotation.UnrotateVector(Dir);
+
+			double TMin = 0.0;
+			double TMax = UE_BIG_NUMBER;
+			int32 HitAxis = INDEX_NONE;
+
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				const double Extent = Shape.Extent[Axis];
+
+				if (FMath::Abs(LocalDir[Axis]) < UE_DOUBLE_SMALL_NUMBER)
+				{
+					if (FMath::Abs(LocalStart[Axis]) > Extent) return false;
+					continue;
+				}
+
+				const double InvDir = 1.0 / LocalDir[Axis];
+				double T0 = (-Extent - LocalStart[Axis]) * InvDir;
+				double T1 = (Extent - LocalStart[Axis]) * InvDir;
+				if (T0 > T1) { Swap(T0, T1); }
+
+				if (T0 > TMin) { TMin = T0; HitAxis = Axis; }
+				TMax = FMath::Min(TMax, T1);
+
+				if (TMin > TMax) return false;
+			}
+
+			FVector LocalNormal = FVector::ZeroVector;
+			if (HitAxis != INDEX_NONE)
+			{
+				LocalNormal[HitAxis] = LocalDir[HitAxis] > 0.0 ? -1.0 : 1.0;
+			}
+			else
+			{
+				LocalNormal = -LocalDir;
+			}
+
+			OutDistance = static_cast<float>(TMin);
+			OutNormal = Rotation.RotateVector(LocalNormal);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// UGE_LagCompensationSubsystem
+
+void UGE_LagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Tracked.Reserve(64);
+	TrackedActors.Reserve(64);
+}
+
+void UGE_LagCompensationSubsystem::Deinitialize()
+{
+	Tracked.Empty();
+	TrackedActors.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UGE_LagCompensationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGE_LagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_LagCompensationRecord);
+
+	const double Now = World->GetTimeSeconds();
+
+	for (int32 i = Tracked.Num() - 1; i >= 0; --i)
+	{
+		FTrackedCharacter& Entry = Tracked[i];
+
+		const USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+		if (!Entry.Character.IsValid() || !Mesh)
+		{
+			Tracked.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			TrackedActors.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		Entry.History.Record(Now, [Mesh](int32 BoneIndex)
+		{
+			return Mesh->GetBoneTransform(BoneIndex);
+		});
+	}
+
+	SET_DWORD_STAT(STAT_GE_LagCompensationTracked, Tracked.Num());
+}
+
+TStatId UGE_LagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGE_LagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void UGE_LagCompensationSubsystem::RegisterCharacter(ACharacter* Character)
+{
+	if (!IsValid(Character) || !Character->HasAuthority()) return;
+
+	if (TrackedActors.Contains(Character)) return;
+
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	TArray<FGE_HitboxShape> Shapes;
+	if (!BuildShapes(Mesh, Shapes))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Lag compensation: %s has no physics asset bodies to record"), *GetNameSafe(Character));
+		return;
+	}
+
+	if (const IGE_CharacterInterface* CharacterInterface = Cast<IGE_CharacterInterface>(Character))
+	{
+		for (FGE_HitboxShape& Shape : Shapes)
+		{
+			Shape.DamageZone = CharacterInterface->GetDamageZoneForBone(Shape.BoneName);
+		}
+	}
+
+	FTrackedCharacter& Entry = Tracked.AddDefaulted_GetRef();
+	Entry.Character = Character;
+	Entry.Mesh = Mesh;
+	Entry.History.Init(MoveTemp(Shapes), CVarLagCompensationHistoryFrames.GetValueOnGameThread());
+
+	TrackedActors.Add(Character);
+}
+
+void UGE_LagCompensationSubsystem::UnregisterCharacter(ACharacter* Character)
+{
+	const int32 Index = TrackedActors.Find(Character);
+	if (Index == INDEX_NONE) return;
+
+	Tracked.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TrackedActors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void UGE_LagCompensationSubsystem::AddTrackedActorsToQuery(FCollisionQueryParams& Params) const
+{
+	Params.AddIgnoredActors(TrackedActors);
+}
+
+bool UGE_LagCompensationSubsystem::TraceRewound(const FVector& Start, const FVector& End, double Timestamp, const AActor* IgnoreActor, FGE_ShotHit& OutShotHit) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GE_LagCompensationRewind);
+
+	FVector Dir;
+	float Length;
+	(End - Start).ToDirectionAndLength(Dir, Length);
+	if (Length <= UE_KINDA_SMALL_NUMBER) return false;
+
+	const double Time = ClampRewindTime(Timestamp);
+
+	int32 BestEntry = INDEX_NONE;
+	FGE_HitboxRaycastResult Best;
+	Best.Distance = Length;
+
+	for (int32 i = 0; i < Tracked.Num(); ++i)
+	{
+		if (TrackedActors[i] == IgnoreActor) continue;
+
+		FGE_HitboxRaycastResult Result;
+		if (Tracked[i].History.Raycast(Start, Dir, Best.Distance, Time, Result))
+		{
+			Best = Result;
+			BestEntry = i;
+		}
+	}
+
+	if (BestEntry == INDEX_NONE) return false;
+
+	const FTrackedCharacter& Entry = Tracked[BestEntry];
+	const FGE_HitboxShape& Shape = Entry.History.GetShapes()[Best.ShapeIndex];
+
+	FHitResult& OutHit = OutShotHit.Hit;
+	OutHit = FHitResult(Start, End);
+	OutHit.bBlockingHit = true;
+	OutHit.Distance = Best.Distance;
+	OutHit.Time = Best.Distance / Length;
+	OutHit.Location = OutHit.ImpactPoint = Start + Dir * Best.Distance;
+	OutHit.Normal = OutHit.ImpactNormal = Best.Normal;
+	OutHit.BoneName = Shape.BoneName;
+	OutHit.PhysMaterial = Shape.PhysMaterial.Get();
+	OutHit.HitObjectHandle = FActorInstanceHandle(Entry.Character.Get());
+	OutHit.Component = Entry.Mesh.Get();
+
+	OutShotHit.SurfaceType = Shape.SurfaceType;
+	OutShotHit.FaceMaterial = nullptr;
+	OutShotHit.BoneName = Shape.BoneName;
+	OutShotHit.BoneIndex = Shape.BoneIndex;
+	OutShotHit.DamageZone = Shape.DamageZone;
+	OutShotHit.Range = Best.Distance;
+
+	return true;
+}
+
+double UGE_LagCompensationSubsystem::ClampRewindTime(double Timestamp) const
+{
+	const UWorld* World = GetWorld();
+	if (!World) return Timestamp;
+
+	const double Now = World->GetTimeSeconds();
+	return FMath::Clamp(Timestamp, Now - CVarLagCompensationMaxRewind.GetValueOnGameThread(), Now);
+}
+
+double UGE_LagCompensationSubsystem::GetViewTimestamp(const APawn* Viewer)
+{
+	const UWorld* World = Viewer ? Viewer->GetWorld() : nullptr;
+	if (!World) return 0.0;
+
+	const AGameStateBase* GameState = World->GetGameState();
+	if (!GameState) return World->GetTimeSeconds();
+
+	double Timestamp = GameState->GetServerWorldTimeSeconds();
+
+	// Remote pawns are rendered roughly half a round trip behind the server
+	if (Viewer->GetLocalRole() == ROLE_AutonomousProxy)
+	{
+		if (const APlayerState* PlayerState = Viewer->GetPlayerState())
+		{
+			Timestamp -= PlayerState->GetPingInMilliseconds() * 0.0005;
+		}
+	}
+
+	return Timestamp;
+}
+
+bool UGE_LagCompensationSubsystem::BuildShapes(const USkeletalMeshComponent* Mesh, TArray<FGE_HitboxShape>& OutShapes)
+{
+	const UPhysicsAsset* PhysicsAsset = Mesh ? Mesh->GetPhysicsAsset() : nullptr;
+	if (!PhysicsAsset) return false;
+
+	// Bone transforms already carry the mesh scale and apply it to the local offset, only the extents need it here
+	const float Scale = static_cast<float>(Mesh->GetComponentScale().GetAbsMax());
+
+	for (const USkeletalBodySetup* Body : PhysicsAsset->SkeletalBodySetups)
+	{
+		if (!Body) continue;
+
+		const int32 BoneIndex = Mesh->GetBoneIndex(Body->BoneName);
+		if (BoneIndex == INDEX_NONE) continue;
+
+		auto AddShape = [&](EGE_HitboxShapeType Type, const FTransform& Local, const FVector3f& Extent)
+		{
+			FGE_HitboxShape& Shape = OutShapes.AddDefaulted_GetRef();
+			Shape.Type = Type;
+			Shape.LocalTransform = Local;
+			Shape.LocalTransform.SetScale3D(FVector::OneVector);
+			Shape.Extent = Extent * Scale;
+			Shape.BoneIndex = BoneIndex;
+			Shape.BoneName = Body->BoneName;
+			Shape.PhysMaterial = Body->PhysMaterial;
+			Shape.SurfaceType = Body->PhysMaterial ? Body->PhysMaterial->SurfaceType : SurfaceType_Default;
+		};
+
+		for (const FKSphereElem& Elem : Body->AggGeom.SphereElems)
+		{
+			AddShape(EGE_HitboxShapeType::Sphere, Elem.GetTransform(), FVector3f(Elem.Radius, 0.f, 0.f));
+		}
+		for (const FKSphylElem& Elem : Body->AggGeom.SphylElems)
+		{
+			AddShape(EGE_HitboxShapeType::Capsule, Elem.GetTransform(), FVector3f(Elem.Radius, 0.f, Elem.Length * 0.5f));
+		}
+		for (const FKBoxElem& Elem : Body->AggGeom.BoxElems)
+		{
+			AddShape(EGE_HitboxShapeType::Box, Elem.GetTransform(), FVector3f(Elem.X, Elem.Y, Elem.Z) * 0.5f);
+		}
+	}
+
+	return OutShapes.Num() > 0;
+}
+
+// Benchmark
+
+static void GE_LagCompensationBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumCharacters = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 64;
+	const int32 NumShots = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10000;
+	const double Scale = Args.Num() > 2 ? FMath::Max(0.01, FCString::Atod(*Args[2])) : 1.0;
+	const int32 NumFrames = CVarLagCompensationHistoryFrames.GetValueOnGameThread();
+
+	constexpr int32 NumBones = 18;
+	constexpr double TickRate = 1.0 / 60.0;
+
+	FRandomStream Rand(1337);
+
+	TArray<FGE_HitboxHistory> Histories;
+	Histories.SetNum(FMath::Max(1, NumCharacters));
+	int32 NumMisplaced = 0;
+
+	for (int32 c = 0; c < Histories.Num(); ++c)
+	{
+		TArray<FGE_HitboxShape> Shapes;
+		for (int32 b = 0; b < NumBones; ++b)
+		{
+			FGE_HitboxShape& Shape = Shapes.AddDefaulted_GetRef();
+			Shape.Type = b == 0 ? EGE_HitboxShapeType::Sphere : (b % 5 == 0 ? EGE_HitboxShapeType::Box : EGE_HitboxShapeType::Capsule);
+			// Laid out as BuildShapes would for a mesh at Scale: unscaled offsets, scaled extents
+			Shape.Extent = FVector3f(6.f, 6.f, 12.f) * static_cast<float>(Scale);
+			Shape.BoneIndex = b;
+			Shape.LocalTransform.SetTranslation(FVector(0.0, 0.0, b * 9.0));
+		}
+
+		Histories[c].Init(MoveTemp(Shapes), NumFrames);
+
+		const FVector Origin(Rand.FRandRange(-5000.0, 5000.0), Rand.FRandRange(-5000.0, 5000.0), 0.0);
+		for (int32 f = 0; f < NumFrames; ++f)
+		{
+			const FVector Offset(f * 5.0, 0.0, 0.0);
+			Histories[c].Record(f * TickRate, [&Origin, &Offset, Scale](int32)
+			{
+				return FTransform(FQuat::Identity, Origin + Offset, FVector(Scale));
+			});
+		}
+
+		// The bone transform scales the offset once, the top shape must sit where the scaled mesh puts it
+		FGE_HitboxRaycastResult Result;
+		const FVector Top = Origin + FVector((NumFrames - 1) * 5.0, 0.0, (NumBones - 1) * 9.0 * Scale);
+		if (!Histories[c].Raycast(Top + FVector(0.0, -1000.0, 0.0), FVector(0.0, 1.0, 0.0), 2000.f, (NumFrames - 1) * TickRate, Result))
+		{
+			++NumMisplaced;
+		}
+	}
+
+	if (NumMisplaced > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Lag compensation benchmark: %d of %d characters have hitboxes away from their scaled bones"), NumMisplaced, Histories.Num());
+	}
+
+	const double NewestTime = (NumFrames - 1) * TickRate;
+	int32 NumHits = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 s = 0; s < NumShots; ++s)
+	{
+		const FVector Start(Rand.FRandRange(-5000.0, 5000.0), Rand.FRandRange(-5000.0, 5000.0), 90.0);
+		const FVector Dir = FVector(Rand.FRandRange(-1.0, 1.0), Rand.FRandRange(-1.0, 1.0), 0.0).GetSafeNormal();
+		const double Time = NewestTime - Rand.FRandRange(0.0, 0.3);
+
+		float BestDistance = 20000.f;
+		for (const FGE_HitboxHistory& History : Histories)
+		{
+			FGE_HitboxRaycastResult Result;
+			if (History.Raycast(Start, Dir, BestDistance, Time, Result))
+			{
+				BestDistance = Result.Distance;
+				++NumHits;
+			}
+		}
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Display, TEXT("Lag compensation benchmark: %d characters at scale %.2f, %d frames, %d shots, %d hits. %.3f us per shot"),
+		Histories.Num(), Scale, NumFrames, NumShots, NumHits, NumShots > 0 ? Elapsed * 1.0e6 / NumShots : 0.0);
+}
+
+static FAutoConsoleCommand CmdLagCompensationBenchmark(
+	TEXT("GE.LagCompensation.Benchmark"),
+	TEXT("Reports rewind cost per shot and checks hitbox placement on meshes at Scale.\nArgs: [NumCharacters=64] [NumShots=10000] [Scale=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&GE_LagCompensationBenchmark));
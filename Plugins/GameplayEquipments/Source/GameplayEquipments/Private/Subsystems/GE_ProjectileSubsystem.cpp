@@ -0,0 +1,277 @@
+#include "Subsystems/GE_ProjectileSubsystem.h"
+
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+#include "Misc/GE_Stats.h"
+#include "Misc/GE_Types.h"
+#include "Equipments/GE_FireWeapon.h"
+#include "Subsystems/GE_LagCompensationSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectiles Resolve"), STAT_GE_ProjectilesResolve, STATGROUP_GameplayEquipments);
+DECLARE_CYCLE_STAT(TEXT("Projectiles Integrate"), STAT_GE_ProjectilesIntegrate, STATGROUP_GameplayEquipments);
+DECLARE_CYCLE_STAT(TEXT("Projectiles Issue"), STAT_GE_ProjectilesIssue, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles Live"), STAT_GE_ProjectilesLive, STATGROUP_GameplayEquipments);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles Hits"), STAT_GE_ProjectilesHits, STATGROUP_GameplayEquipments);
+
+void UGE_ProjectileSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	constexpr int32 InitialCapacity = 1024;
+	Weapons.Reserve(InitialCapacity);
+	Origins.Reserve(InitialCapacity);
+	Positions.Reserve(InitialCapacity);
+	PrevPositions.Reserve(InitialCapacity);
+	Velocities.Reserve(InitialCapacity);
+	GravityZs.Reserve(InitialCapacity);
+	Drags.Reserve(InitialCapacity);
+	Ages.Reserve(InitialCapacity);
+	Lifetimes.Reserve(InitialCapacity);
+	RewindTimes.Reserve(InitialCapacity);
+	Channels.Reserve(InitialCapacity);
+	CosmeticFlags.Reserve(InitialCapacity);
+	Handles.Reserve(InitialCapacity);
+}
+
+void UGE_ProjectileSubsystem::Deinitialize()
+{
+	Weapons.Empty();
+	Origins.Empty();
+	Positions.Empty();
+	PrevPositions.Empty();
+	Velocities.Empty();
+	GravityZs.Empty();
+	Drags.Empty();
+	Ages.Empty();
+	Lifetimes.Empty();
+	RewindTimes.Empty();
+	Channels.Empty();
+	CosmeticFlags.Empty();
+	Handles.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UGE_ProjectileSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGE_ProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Last tick's segments first, bullets that hit something never move again
+	ResolveTraces();
+	Integrate(DeltaTime);
+	IssueTraces();
+
+	SET_DWORD_STAT(STAT_GE_ProjectilesLive, Weapons.Num());
+}
+
+TStatId UGE_ProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGE_ProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UGE_ProjectileSubsystem::Launch(AGE_FireWeapon* Weapon, uint16 ShotSequence, const FVector& Start, const FVector& Velocity, double RewindTimestamp, bool bCosmetic)
+{
+	if (!IsValid(Weapon)) return;
+
+	Weapons.Add(Weapon);
+	ShotSequences.Add(ShotSequence);
+	Origins.Add(Start);
+	Positions.Add(Start);
+	PrevPositions.Add(Start);
+	Velocities.Add(Velocity);
+	GravityZs.Add(GetWorld()->GetGravityZ() * Weapon->ProjectileGravityScale);
+	Drags.Add(Weapon->ProjectileDrag);
+	Ages.Add(0.f);
+	Lifetimes.Add(Weapon->ProjectileLifetime);
+	RewindTimes.Add(RewindTimestamp);
+	Channels.Add(Weapon->TraceChannel);
+	CosmeticFlags.Add(bCosmetic ? 1 : 0);
+	Handles.AddDefaulted();
+}
+
+void UGE_ProjectileSubsystem::ResolveTraces()
+{
+	if (Weapons.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_ProjectilesResolve);
+
+	UWorld* World = GetWorld();
+	const UGE_LagCompensationSubsystem* LagCompensation = World->GetSubsystem<UGE_LagCompensationSubsystem>();
+
+	Removals.Reset();
+
+	for (int32 i = 0; i < Weapons.Num(); ++i)
+	{
+		AGE_FireWeapon* Weapon = Weapons[i].Get();
+		if (!Weapon)
+		{
+			Removals.Add(i);
+			continue;
+		}
+
+		if (!Handles[i].IsValid()) continue;
+
+		FTraceDatum Datum;
+		if (!World->QueryTraceData(Handles[i], Datum)) continue;
+
+		const FVector& Start = PrevPositions[i];
+		const FVector& End = Positions[i];
+
+		FGE_ShotHit ShotHit = FGE_ShotHit::Resolve(Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult(Start, End));
+
+		if (LagCompensation && RewindTimes[i] >= 0.0)
+		{
+			const FVector RewindEnd = ShotHit.Hit.bBlockingHit ? FVector(ShotHit.Hit.Location) : End;
+
+			FGE_ShotHit RewoundHit;
+			if (LagCompensation->TraceRewound(Start, RewindEnd, RewindTimes[i] + Ages[i], Weapon->GetOwner(), RewoundHit))
+			{
+				RewoundHit.Hit.TraceEnd = End;
+				ShotHit = MoveTemp(RewoundHit);
+			}
+		}
+
+		if (!ShotHit.IsValidBlockingHit()) continue;
+
+		// The trace only covers this tick's segment
+		ShotHit.Range = FVector::Dist(Origins[i], ShotHit.Hit.ImpactPoint);
+
+		INC_DWORD_STAT(STAT_GE_ProjectilesHits);
+
+		if (CosmeticFlags[i])
+		{
+			Weapon->SpawnImpactFXHandler(ShotHit);
+		}
+		else
+		{
+			Weapon->HandleShotHit(ShotHit, ShotSequences[i]);
+			DamagedWeapons.AddUnique(Weapon);
+		}
+
+		Removals.Add(i);
+	}
+
+	// Descending so swaps never move a row that is still to be removed
+	for (int32 r = Removals.Num() - 1; r >= 0; --r)
+	{
+		RemoveAtSwap(Removals[r]);
+	}
+
+	// Pellets of one shot landing in the same frame reach each victim as one event
+	for (const TWeakObjectPtr<AGE_FireWeapon>& DamagedWeapon : DamagedWeapons)
+	{
+		if (DamagedWeapon.IsValid())
+		{
+			DamagedWeapon->ApplyPendingShotDamage();
+		}
+	}
+	DamagedWeapons.Reset();
+}
+
+void UGE_ProjectileSubsystem::Integrate(float DeltaTime)
+{
+	if (Weapons.Num() == 0 || DeltaTime <= 0.f) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_ProjectilesIntegrate);
+
+	FVector* RESTRICT Pos = Positions.GetData();
+	FVector* RESTRICT Prev = PrevPositions.GetData();
+	FVector* RESTRICT Vel = Velocities.GetData();
+	float* RESTRICT Age = Ages.GetData();
+	const float* RESTRICT Gravity = GravityZs.GetData();
+	const float* RESTRICT Drag = Drags.GetData();
+
+	constexpr int32 BatchSize = 256;
+	const int32 NumBatches = FMath::DivideAndRoundUp(Weapons.Num(), BatchSize);
+	const int32 Num = Weapons.Num();
+
+	ParallelFor(NumBatches, [=](int32 Batch)
+	{
+		const int32 First = Batch * BatchSize;
+		const int32 Last = FMath::Min(First + BatchSize, Num);
+
+		for (int32 i = First; i < Last; ++i)
+		{
+			// Semi-implicit Euler, linear drag
+			FVector V = Vel[i];
+			V.Z += Gravity[i] * DeltaTime;
+			V *= FMath::Max(0.f, 1.f - Drag[i] * DeltaTime);
+
+			Prev[i] = Pos[i];
+			Pos[i] += V * DeltaTime;
+			Vel[i] = V;
+			Age[i] += DeltaTime;
+		}
+	});
+
+	Removals.Reset();
+	for (int32 i = 0; i < Num; ++i)
+	{
+		if (Ages[i] > Lifetimes[i])
+		{
+			Removals.Add(i);
+		}
+	}
+
+	for (int32 r = Removals.Num() - 1; r >= 0; --r)
+	{
+		RemoveAtSwap(Removals[r]);
+	}
+}
+
+void UGE_ProjectileSubsystem::IssueTraces()
+{
+	if (Weapons.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_GE_ProjectilesIssue);
+
+	UWorld* World = GetWorld();
+	const UGE_LagCompensationSubsystem* LagCompensation = World->GetSubsystem<UGE_LagCompensationSubsystem>();
+	const bool bReturnFaceIndex = !UPhysicsSettings::Get()->bSuppressFaceRemapTable;
+
+	for (int32 i = 0; i < Weapons.Num(); ++i)
+	{
+		const AGE_FireWeapon* Weapon = Weapons[i].Get();
+		if (!Weapon)
+		{
+			Handles[i] = FTraceHandle();
+			continue;
+		}
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(ProjectileTrace), true, Weapon->GetOwner());
+		Params.bReturnPhysicalMaterial = true;
+		Params.bReturnFaceIndex = bReturnFaceIndex;
+
+		if (LagCompensation && RewindTimes[i] >= 0.0)
+		{
+			LagCompensation->AddTrackedActorsToQuery(Params);
+		}
+
+		Handles[i] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, PrevPositions[i], Positions[i], Channels[i], Params);
+	}
+}
+
+void UGE_ProjectileSubsystem::RemoveAtSwap(int32 Index)
+{
+	Weapons.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ShotSequences.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Origins.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Positions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	PrevPositions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GravityZs.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Drags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Ages.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Lifetimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	RewindTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Channels.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CosmeticFlags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Handles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
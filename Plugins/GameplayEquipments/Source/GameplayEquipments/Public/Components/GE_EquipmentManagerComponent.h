@@ -2,11 +2,13 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Net/Serialization/FastArraySerializer.h"
 #include "Misc/GE_Types.h"
 #include "GE_EquipmentManagerComponent.generated.h"
 
 class AGE_Equipment;
 class ACharacter;
+class UGE_EquipmentManagerComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnEquipmentChanged, AGE_Equipment*, NewEquipment, AGE_Equipment*, OldEquipment);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnEquipmentAdded, AGE_Equipment*, Equipment, int32, SlotIndex);
@@ -20,15 +22,87 @@ enum class EGE_EquipFlowPhase : uint8
 	Equipping
 };
 
+/** Where the server's swap is, replicated to everyone in place of per-step multicasts. */
+USTRUCT()
+struct FGE_EquipFlowState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	EGE_EquipFlowPhase Phase = EGE_EquipFlowPhase::Idle;
+
+	// Slot being put away while Unequipping
+	UPROPERTY()
+	int8 FromIndex = INDEX_NONE;
+
+	// Slot the flow ends on, the equipped one once Idle
+	UPROPERTY()
+	int8 ToIndex = INDEX_NONE;
+
+	// Last owner request the server applied, so the owner knows when its prediction can be checked
+	UPROPERTY()
+	uint8 RequestId = 0;
+};
+
+/** One occupied slot. Empty slots have no entry. */
+USTRUCT()
+struct FGE_EquipmentSlotEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<AGE_Equipment> Equipment;
+
+	UPROPERTY()
+	int32 SlotIndex = INDEX_NONE;
+
+	void PreReplicatedRemove(const struct FGE_EquipmentSlotList& InArraySerializer);
+	void PostReplicatedAdd(const struct FGE_EquipmentSlotList& InArraySerializer);
+	void PostReplicatedChange(const struct FGE_EquipmentSlotList& InArraySerializer);
+};
+
+/** Replicates only the slots that changed. Clients get one callback per added, changed or removed entry. */
+USTRUCT()
+struct FGE_EquipmentSlotList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	FGE_EquipmentSlotList() : OwnerComponent(nullptr) {}
+	FGE_EquipmentSlotList(UGE_EquipmentManagerComponent* InOwnerComponent) : OwnerComponent(InOwnerComponent) {}
+
+	UPROPERTY()
+	TArray<FGE_EquipmentSlotEntry> Entries;
+
+	UPROPERTY(NotReplicated)
+	TObjectPtr<UGE_EquipmentManagerComponent> OwnerComponent;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FGE_EquipmentSlotEntry, FGE_EquipmentSlotList>(Entries, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FGE_EquipmentSlotList> : public TStructOpsTypeTraitsBase2<FGE_EquipmentSlotList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
 UCLASS(ClassGroup=(GameplayEquipments), meta=(BlueprintSpawnableComponent, DisplayName="Equipment Manager"))
 class GAMEPLAYEQUIPMENTS_API UGE_EquipmentManagerComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	friend struct FGE_EquipmentSlotEntry;
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Equipment Manager")
 	int32 MaxSlots = 6;
 
+	// Removed equipment goes back to the world's equipment pool, destroyed only when the pool is full
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Equipment Manager")
 	uint8 bDestroyOnRemove : 1;
 
@@ -54,16 +128,28 @@ public:
 	FOnEquipmentRemoved OnEquipmentRemoved;
 	
 protected:
-	UPROPERTY(ReplicatedUsing=OnRep_Slots)
+	UPROPERTY(Replicated)
+	FGE_EquipmentSlotList SlotList;
+
+	// Indexed by slot, built from SlotList on every machine
+	UPROPERTY(Transient)
 	TArray<TObjectPtr<AGE_Equipment>> Slots;
 
 	UPROPERTY(ReplicatedUsing=OnRep_CurrentIndex)
 	int32 CurrentIndex = INDEX_NONE;
 
+	UPROPERTY(ReplicatedUsing=OnRep_FlowState)
+	FGE_EquipFlowState FlowState;
+
 	EGE_EquipFlowPhase FlowPhase = EGE_EquipFlowPhase::Idle;
 
 	int32 PendingIndex = INDEX_NONE;
 
+	// Clients, slot the local animations are showing. The owner runs ahead of the server here.
+	int32 LocalIndex = INDEX_NONE;
+
+	uint8 LocalRequestId = 0;
+
 	FTimerHandle FlowTimer;
 
 public:
@@ -100,6 +186,9 @@ protected:
 
 	bool UseFirstPersonLocally() const;
 
+	/** Owning client, runs the swap locally before the server confirms it. */
+	bool IsPredictingFlow() const;
+
 	void EnsureCapacity();
 	int32 FindNextIndex(int32 Delta) const;
 
@@ -107,6 +196,12 @@ protected:
 	void BeginServerSwap(int32 ToIndex);
 	void Server_UnequipFinished();
 	void Server_EquipFinished();
+	void Server_SetFlowState(EGE_EquipFlowPhase Phase, int32 FromIndex, int32 ToIndex);
+
+	// Predicted flow (owning client)
+	void RequestSwap(int32 ToIndex);
+	void PredictSwap(int32 ToIndex);
+	int32 GetPredictedTarget() const;
 
 	// Cosmetic flow (all clients)
 	void Local_BeginUnequip(int32 FromIndex, int32 ChainToIndex = INDEX_NONE);
@@ -115,6 +210,10 @@ protected:
 
 	void Local_CancelUnequip(int32 Index);
 
+	/** Catches the local flow up to FlowState, skipping steps that were missed. */
+	void Local_ApplyFlowState();
+	void Local_SetShownIndex(int32 NewIndex);
+
 	float StartUnequipOnRole(AGE_Equipment* Eq, bool bLocalFP) const;
 	float StartEquipOnRole(AGE_Equipment* Eq, bool bLocalFP) const;
 	void FinishUnequipOnRole(AGE_Equipment* Eq) const;
@@ -122,27 +221,19 @@ protected:
 
 	void BroadcastChanged(AGE_Equipment* NewEq, AGE_Equipment* OldEq);
 
-	UFUNCTION()
-	void OnRep_Slots();
+	// Client side, from the slot list callbacks
+	void HandleSlotAdded(int32 SlotIndex, AGE_Equipment* Equipment);
+	void HandleSlotRemoved(int32 SlotIndex);
 
 	UFUNCTION()
 	void OnRep_CurrentIndex(int32 OldIndex);
 
-protected:
-	UFUNCTION(Server, Reliable)
-	void ServerEquipSlot(int32 SlotIndex);
+	UFUNCTION()
+	void OnRep_FlowState();
 
+protected:
 	UFUNCTION(Server, Reliable)
-	void ServerCycle(int32 Delta);
-
-	UFUNCTION(NetMulticast, Reliable)
-	void MulticastBeginUnequip(int32 FromIndex);
-
-	UFUNCTION(NetMulticast, Reliable)
-	void MulticastBeginEquip(int32 ToIndex);
-
-	UFUNCTION(NetMulticast, Reliable)
-	void MulticastCancelUnequip(int32 Index);
+	void ServerEquipSlot(int32 SlotIndex, uint8 RequestId);
 
 public:
 	UFUNCTION(BlueprintPure, Category="Equipment")
@@ -69,6 +69,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Equipment|State")
 	uint8 bOwnerIsFirstPerson : 1;
 
+	// Holstered: meshes unregistered, no tick, net dormant on the server
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Equipment|State")
+	uint8 bDehydrated : 1;
+
 	UPROPERTY()
 	TWeakObjectPtr<ACharacter> OwningCharacter;
 
@@ -115,6 +119,12 @@ protected:
 
 	virtual void UpdateTickAndVisibility();
 
+	/** Drops everything a holstered item doesn't need. Undone within the same call, so equip can animate right away. */
+	virtual void SetDehydrated(bool bNewDehydrated);
+
+	/** Push model marks don't reach a dormant actor, call after changing replicated state while dehydrated. */
+	void FlushDehydratedState();
+
 	UFUNCTION()
 	virtual void OnRep_EquipState();
 
@@ -133,6 +143,9 @@ public:
 
 	virtual void OnBeforeRemoved(UGE_EquipmentManagerComponent* Manager, EGE_EquipmentRemovalReason Reason) {}
 
+	/** Back to a freshly spawned, ownerless and holstered state before UGE_EquipmentPoolSubsystem parks it. Authority only. */
+	virtual void ResetForPool();
+
 	virtual void UpdateViewMode(bool bFirstPerson);
 
 	virtual FVector GetPivotPoint() const;
@@ -149,4 +162,7 @@ public:
 	UFUNCTION(BlueprintPure, Category="State")
 	FORCEINLINE bool IsEquipped() const { return bEquipped; }
 
+	UFUNCTION(BlueprintPure, Category="State")
+	FORCEINLINE bool IsDehydrated() const { return bDehydrated; }
+
 };
@@ -2,10 +2,16 @@
 
 #include "CoreMinimal.h"
 #include "Equipments/GE_Equipment.h"
+#include "Misc/GE_FireScheduler.h"
+#include "Engine/NetSerialization.h"
 #include "GE_FireWeapon.generated.h"
 
 class USoundBase;
 class UDamageType;
+class UDataAsset;
+class UGE_ImpactFXData;
+class UGE_PenetrationData;
+class UGE_DamageProfileData;
 
 UENUM(BlueprintType)
 enum class EGEFireMode : uint8
@@ -15,6 +21,10 @@ enum class EGEFireMode : uint8
 	Auto  = 2
 };
 
+/**
+ * A single shot as sent over the network: origin, aim, spread and sequence number.
+ * Pellet directions are never sent, every machine regenerates them from the quantized fields.
+ */
 USTRUCT(BlueprintType)
 struct FGE_BulletData
 {
@@ -24,45 +34,238 @@ struct FGE_BulletData
 	FVector_NetQuantize100 StartLocation = FVector_NetQuantize100::ZeroVector;
 
 	UPROPERTY(BlueprintReadOnly)
-	TArray<FVector_NetQuantizeNormal> Directions;
+	FRotator AimRotation = FRotator::ZeroRotator;
 
+	// Degrees, sent with 0.01 precision
 	UPROPERTY(BlueprintReadOnly)
+	float Spread = 0.f;
+
+	// Seeds the pellet stream
+	UPROPERTY()
+	uint16 ShotSequence = 0;
+
+	// Derived, see GenerateDirections
+	UPROPERTY(BlueprintReadOnly, NotReplicated)
+	TArray<FVector_NetQuantizeNormal> Directions;
+
+	UPROPERTY(BlueprintReadOnly, NotReplicated)
 	TArray<FVector_NetQuantize100> EndLocations;
 
 	FGE_BulletData() {};
 
-	FGE_BulletData(const FVector& InStart, const FVector& InDir, const FVector& InEnd)
+	FGE_BulletData(const FVector& InStart, const FRotator& InAim, float InSpread, uint16 InShotSequence)
+		: StartLocation(InStart), AimRotation(InAim), Spread(InSpread), ShotSequence(InShotSequence)
+	{}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	/** Rounds the replicated fields to exactly what the receiving side will decode. */
+	void Quantize();
+
+	/** Rebuilds Directions and EndLocations from the replicated fields. */
+	void GenerateDirections(int32 NumPellets, float TraceDist);
+
+	static void GeneratePelletDirections(const FRotator& Aim, float Spread, uint16 ShotSequence, int32 NumPellets, TArray<FVector>& OutDirections);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGE_BulletData> : public TStructOpsTypeTraitsBase2<FGE_BulletData>
+{
+	enum
 	{
-		StartLocation = InStart;
-		Directions.Add(InDir.GetSafeNormal());
-		EndLocations.Add(InEnd);
-	}
+		WithNetSerializer = true
+	};
+};
+
+UENUM()
+enum class EGE_WeaponCommandType : uint8
+{
+	Fire,
+	SetFiring,
+	SetAiming,
+	StartReload,
+	InsertRound,
+	CommitReload,
+	CancelReload,
+	SetFireMode
+};
+
+/** One owner to server action on the weapon command stream. */
+USTRUCT()
+struct FGE_WeaponCommand
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	UPROPERTY()
+	EGE_WeaponCommandType Type = EGE_WeaponCommandType::Fire;
+
+	// SetFiring/SetAiming: bool, CommitReload: force full, SetFireMode: EGEFireMode
+	UPROPERTY()
+	uint8 Param = 0;
+
+	// Fire only
+	UPROPERTY()
+	FGE_BulletData Shot;
+
+	// Sent by the packet as a millisecond offset from its base time, not by NetSerialize
+	UPROPERTY()
+	double FireTime = -1.0;
+
+	FGE_WeaponCommand() {};
+
+	FGE_WeaponCommand(EGE_WeaponCommandType InType, uint8 InParam = 0)
+		: Type(InType), Param(InParam)
+	{}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
 
-	FGE_BulletData(const FVector& InStart, const TArray<FVector>& InDirs, const TArray<FVector>& InEnds)
+template<>
+struct TStructOpsTypeTraits<FGE_WeaponCommand> : public TStructOpsTypeTraitsBase2<FGE_WeaponCommand>
+{
+	enum
 	{
-		StartLocation = InStart;
-		Directions.Reserve(InDirs.Num());
-		EndLocations.Reserve(InEnds.Num());
-		for (int32 i = 0; i < InDirs.Num(); ++i)
-		{
-			Directions.Add(InDirs[i].GetSafeNormal());
-		}
-		for (int32 i = 0; i < InEnds.Num(); ++i)
-		{
-			EndLocations.Add(InEnds[i]);
-		}
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Every command the server has not acknowledged yet, oldest first with consecutive sequences.
+ * Sent unreliably and repeated until acked, so a lost packet is covered by the next one.
+ * Fire times go out once as a full base time, then as 16 bit millisecond offsets from it.
+ */
+USTRUCT()
+struct FGE_WeaponCommandPacket
+{
+	GENERATED_BODY()
+
+	static constexpr int32 MaxCommands = 32;
+
+	UPROPERTY()
+	TArray<FGE_WeaponCommand> Commands;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGE_WeaponCommandPacket> : public TStructOpsTypeTraitsBase2<FGE_WeaponCommandPacket>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/** The part of the weapon state the command stream changes, predicted by the owner ahead of the server. */
+struct FGE_WeaponPredictedState
+{
+	int32 AmmoInMag = 0;
+	int32 TotalAmmo = 0;
+	bool bIsReloading = false;
+	EGEFireMode FireMode = EGEFireMode::Semi;
+
+	bool operator==(const FGE_WeaponPredictedState& Other) const
+	{
+		return AmmoInMag == Other.AmmoInMag && TotalAmmo == Other.TotalAmmo && bIsReloading == Other.bIsReloading && FireMode == Other.FireMode;
 	}
+
+	bool operator!=(const FGE_WeaponPredictedState& Other) const { return !(*this == Other); }
+};
+
+struct FGE_WeaponPrediction
+{
+	uint16 CommandSequence = 0;
+	uint16 ShotSequence = 0;
+	FGE_WeaponPredictedState State;
+};
+
+/** Which parts of FGE_WeaponNetState an update changed. */
+UENUM(BlueprintType, meta=(Bitflags, UseEnumValuesAsMaskValuesInEditor="true"))
+enum class EGE_WeaponStateField : uint8
+{
+	None      = 0 UMETA(Hidden),
+	AmmoInMag = 1 << 0,
+	TotalAmmo = 1 << 1,
+	Firing    = 1 << 2,
+	Reloading = 1 << 3,
+	Aiming    = 1 << 4,
+	FireMode  = 1 << 5,
+	Bullet    = 1 << 6
+};
+ENUM_CLASS_FLAGS(EGE_WeaponStateField);
+
+/**
+ * Everything the weapon replicates besides the command ack, as one property.
+ * Each update only carries the groups that differ from the connection's last acked state:
+ * magazine sized to the magazine capacity, reserve packed, flags and fire mode in one byte, and the last shot.
+ */
+USTRUCT(BlueprintType)
+struct FGE_WeaponNetState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 AmmoInMag = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 TotalAmmo = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bIsFiring = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bIsReloading = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bIsAiming = false;
+
+	UPROPERTY(BlueprintReadOnly)
+	EGEFireMode FireMode = EGEFireMode::Semi;
+
+	UPROPERTY(BlueprintReadOnly)
+	FGE_BulletData BulletData;
+
+	// Not replicated. Wire range of AmmoInMag, taken from the class default so both ends agree
+	int32 MaxAmmoInMag = 255;
+
+	// Not replicated. The owning client drives firing, aiming and shots itself, received values for them are dropped
+	bool bSkipOwnerFields = false;
+
+	// Receiving side, what the last update changed and the reserve before it
+	EGE_WeaponStateField ChangedFields = EGE_WeaponStateField::None;
+	int32 PreviousTotalAmmo = 0;
+
+	uint8 PackFlags() const;
+	void UnpackFlags(uint8 Packed);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGE_WeaponNetState> : public TStructOpsTypeTraitsBase2<FGE_WeaponNetState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGE_OnAmmunitionChanged, int32, Ammunition, int32, TotalAmmunition);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGE_OnMagazineChanged, int32, MagazineCapacity);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGE_OnFireModeChanged, EGEFireMode, FireMode);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGE_OnWeaponStateChanged, int32, ChangedFields);
 
 UCLASS(Abstract, meta=(DisplayName="Fire Weapon"))
 class GAMEPLAYEQUIPMENTS_API AGE_FireWeapon : public AGE_Equipment
 {
 	GENERATED_BODY()
 
+	friend class UGE_HitscanSubsystem;
+	friend class UGE_ProjectileSubsystem;
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Fire")
 	EGEFireMode FireMode = EGEFireMode::Semi;
@@ -131,11 +334,41 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Damage")
 	TSubclassOf<UDamageType> DamageTypeClass;
 
+	// Range falloff, zone multipliers and armor mitigation, BaseDamage applies flat when unset
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Damage")
+	TObjectPtr<UGE_DamageProfileData> DamageProfile;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Trace")
 	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
 
-	// UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|VFX")
-	// TSubclassOf<AGE_ImpactFXHandler> ImpactFXHandlerClass;
+	// Penetration and ricochet per surface, pellets stop at the first hit when unset
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Trace")
+	TObjectPtr<UGE_PenetrationData> PenetrationData;
+
+	// Simulate bullets with travel time and drop instead of instant traces
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Ballistics")
+	bool bSimulateProjectiles = false;
+
+	// cm/s
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Ballistics", meta=(EditCondition="bSimulateProjectiles", ClampMin=100.0))
+	float MuzzleVelocity = 90000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Ballistics", meta=(EditCondition="bSimulateProjectiles", ClampMin=0.0))
+	float ProjectileGravityScale = 1.0f;
+
+	// Fraction of velocity lost per second
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Ballistics", meta=(EditCondition="bSimulateProjectiles", ClampMin=0.0, ClampMax=10.0))
+	float ProjectileDrag = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Ballistics", meta=(EditCondition="bSimulateProjectiles", ClampMin=0.1))
+	float ProjectileLifetime = 3.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|VFX")
+	TObjectPtr<UGE_ImpactFXData> ImpactFXData;
+
+	// Procedural kick pattern, read by the character's recoil setup
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Recoil", meta=(AllowedClasses="/Script/GameplayAnimation.GA_RecoilData"))
+	TObjectPtr<UDataAsset> RecoilPattern;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings|Weapon|Spread")
 	float ImprecisionBaseAmount = 6.0f;
@@ -189,6 +422,8 @@ public:
 	virtual void OnRep_Owner() override;
 	virtual void OnRep_Instigator() override;
 	virtual void SetActorHiddenInGame(bool bNewHidden) override;
+	virtual void PreNetReceive() override;
+	virtual void PostNetReceive() override;
 	//~ End of AActor
 
 	//~ AGE_Equipment
@@ -197,6 +432,7 @@ public:
 	virtual void OnRep_Equipped() override;
 
 	virtual void OnBeforeRemoved(UGE_EquipmentManagerComponent* Manager, EGE_EquipmentRemovalReason Reason) override;
+	virtual void ResetForPool() override;
 
 	virtual float BeginEquip(bool bFirstPerson, bool bThirdPerson) override;
 	virtual float BeginUnequip(bool bFirstPerson, bool bThirdPerson) override;
@@ -214,34 +450,27 @@ public:
 	FGE_OnMagazineChanged OnMagazineChanged;
 	UPROPERTY(BlueprintAssignable)
 	FGE_OnFireModeChanged OnFireModeChanged;
+	// Once per state update, ChangedFields is a mask of EGE_WeaponStateField
+	UPROPERTY(BlueprintAssignable)
+	FGE_OnWeaponStateChanged OnWeaponStateChanged;
 
 protected:
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_AmmoInMag)
-	int32 AmmoInMag = 0;
-	
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_TotalAmmo)
-	int32 TotalAmmo = 0;
-
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_IsFiring)
-	bool bIsFiring = false;
-
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_IsReloading)
-	bool bIsReloading = false;
+	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_NetState)
+	FGE_WeaponNetState NetState;
 
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_IsAiming)
-	bool bIsAiming = false;
-	
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_BulletData)
-	FGE_BulletData BulletData;
-	
-	UPROPERTY(BlueprintReadOnly, Category="State", ReplicatedUsing=OnRep_FireMode)
-	EGEFireMode RepFireMode = EGEFireMode::Semi;
+	// Last command the server executed, owner only
+	UPROPERTY(ReplicatedUsing=OnRep_AckedCommandSequence)
+	uint16 AckedCommandSequence = 0;
 	
 	UPROPERTY(BlueprintReadOnly, Category="State")
 	FTransform ADSOffset = FTransform::Identity;
 
 	int32 BurstLeft = 0;
 	int32 Imprecision = 0;
+	uint16 ShotSequence = 0;
+
+	FGE_FireScheduler FireScheduler;
+	double LastShotTime = -1.0;
 	int32 BulletFired = 0;
 
 	float AimHoldTime = 0.f;
@@ -264,6 +493,25 @@ protected:
 	FTimerHandle TimerHandle_Fire;
 	FTimerHandle TimerHandle_RunFireDelay;
 
+	FGE_WeaponCommandPacket UnackedCommands;
+	uint16 OutgoingCommandSequence = 0;
+	uint16 LastExecutedCommandSequence = 0;
+	uint8 bCommandFlushPending : 1;
+
+	FTimerHandle TimerHandle_CommandResend;
+
+	// Owner only. Predicted state after each unacked command, checked against the server once it acks
+	TArray<FGE_WeaponPrediction, TInlineAllocator<FGE_WeaponCommandPacket::MaxCommands>> PredictionHistory;
+	FGE_WeaponPredictedState ConfirmedState;
+	FGE_WeaponPredictedState DisplayedState;
+	uint16 ReceiveAckedCommandSequence = 0;
+	uint8 bHasConfirmedState : 1;
+	uint8 bReceivingState : 1;
+	uint8 bStateReconciled : 1;
+
+	// Server only. Pellet hits of the current resolve pass, one event per victim per shot
+	TArray<FGE_ShotDamageEvent, TInlineAllocator<2>> PendingShotDamage;
+
 public:
 	UFUNCTION(BlueprintCallable, Category="Weapon|Ammo")
 	void StartReload();
@@ -284,10 +532,10 @@ public:
 	void AddTotalAmmo(int32 Delta);
 
 	UFUNCTION(BlueprintPure, Category="Weapon|Ammo")
-	int32 GetTotalAmmo() const { return TotalAmmo; }
+	int32 GetTotalAmmo() const { return NetState.TotalAmmo; }
 
 	UFUNCTION(BlueprintPure, Category="Weapon|Ammo")
-	int32 GetAmmoInMagazine() const { return AmmoInMag; }
+	int32 GetAmmoInMagazine() const { return NetState.AmmoInMag; }
 	
 	UFUNCTION(BlueprintPure, Category="Weapon|Ammo")
 	bool CanReload() const;
@@ -328,10 +576,13 @@ public:
 	FTransform GetBulletSpawnTransform() const;
 	
 	UFUNCTION(BlueprintPure, Category="State")
-	bool IsAiming() const { return bIsAiming; }
+	bool IsAiming() const { return NetState.bIsAiming; }
+
+	UFUNCTION(BlueprintPure, Category="State")
+	bool IsFiring() const { return NetState.bIsFiring; }
 
 	UFUNCTION(BlueprintPure, Category="State")
-	bool IsFiring() const { return bIsFiring; }
+	bool IsReloading() const { return NetState.bIsReloading; }
 
 	UFUNCTION(BlueprintPure, Category="State")
 	float GetADSAlpha() const { return ADSAlpha; }
@@ -347,24 +598,36 @@ protected:
 	void BeginFire();
 	void EndFire();
 	void BeginFire_Internal();
-	void FireShot();
+	void RefreshFireSchedule();
+	void FireShot(double ShotTime);
 	void HandleShotFXAndRecoil();
 
-	bool GetHitResult(TArray<FHitResult>& OutHits) const;
-	FHitResult GetHitResultWithPhysMaterial(const FHitResult& InHit) const;
+	bool ShouldTraceImpactFX() const;
+	bool GetHitResult(TArray<FGE_ShotHit>& OutHits) const;
 
-	void SpawnImpactFXHandler(const FHitResult& InHit);
+	void SpawnImpactFXHandler(const FGE_ShotHit& InHit);
 
 	bool CanFire() const;
 
 	bool ShouldUseRunFireDelay() const;
 	void OnRunFireDelayElapsed();
 
-	void ComputeShot(FVector& OutStart, TArray<FVector>& OutDirs, TArray<FVector>& OutEnds);
-	void ApplyShot(const FVector& Start, const TArray<FVector>& Dirs, const TArray<FVector>& Ends);
+	void ComputeShot(FGE_BulletData& OutData);
+	void ApplyShot(const FGE_BulletData& InData, double FireTime = -1.0);
+
+	void LaunchProjectiles(double RewindTimestamp, bool bCosmetic);
+
+	/** Queues a pellet's damage against its victim, called by UGE_HitscanSubsystem or UGE_ProjectileSubsystem once it hits. */
+	void HandleShotHit(const FGE_ShotHit& ShotHit, uint16 ShotSequence);
+
+	/** One TakeDamage per victim per shot for everything HandleShotHit queued, called at the end of each resolve pass. */
+	void ApplyPendingShotDamage();
 
 	float GetImprecision(float AimingRatio, const FVector& OwnerVelocity) const;
 
+	/** Gives back one imprecision step for every fire interval skipped since the previous shot. */
+	void RecoverImprecision(double ShotTime);
+
 protected:
 	bool ConsumeOneFromMagazine();
 	int32 LoadFromReserve(int32 Desired);
@@ -376,50 +639,49 @@ protected:
 	void RefreshADSOffset();
 
 protected:
-	UFUNCTION(Server, Reliable)
-	void ServerSetIsFiring(bool bNew);
-	
-	UFUNCTION(Server, Reliable)
-	void ServerSetIsAiming(bool bNew);
+	void SendCommand(FGE_WeaponCommand&& Command);
+	void FlushCommands();
+	void ExecuteCommand(const FGE_WeaponCommand& Command);
 
-	UFUNCTION(Server, Reliable)
-	void ServerRequestStartReload();
-	
-	UFUNCTION(Server, Reliable)
-	void ServerInsertOneRound();
-	
-	UFUNCTION(Server, Reliable)
-	void ServerCommitReload(bool bForceFull);
-	
-	UFUNCTION(Server, Reliable)
-	void ServerCancelReload();
+	/** Sequences restart from zero on both ends when a pooled weapon gets a new owner. */
+	void ResetCommandStream();
 
-	UFUNCTION(Server, Reliable)
-	void ServerApplyShot(const FVector_NetQuantize100& Start, const TArray<FVector_NetQuantizeNormal>& Dirs, const TArray<FVector_NetQuantize100>& Ends);
+	void ExecuteSetIsFiring(bool bNew);
+	void ExecuteSetIsAiming(bool bNew);
+	void ExecuteStartReload();
+	void ExecuteInsertOneRound();
+	void ExecuteCommitReload(bool bForceFull);
+	void ExecuteCancelReload();
+	void ExecuteSetFireMode(EGEFireMode NewMode);
 
-	UFUNCTION(Server, Reliable)
-	void ServerSetFireMode(EGEFireMode NewMode);
+	UFUNCTION(Server, Unreliable)
+	void ServerSendCommands(const FGE_WeaponCommandPacket& Packet);
 
 protected:
+	bool IsPredictingState() const { return !HasAuthority() && IsLocallyControlled(); }
+
+	FGE_WeaponPredictedState CaptureState() const;
+	void RestoreState(const FGE_WeaponPredictedState& State);
+
+	/** Moves to NewState and fires the same events the OnReps would. */
+	void ApplyPredictedState(const FGE_WeaponPredictedState& NewState);
+
+	void PredictCommand(const FGE_WeaponCommand& Command);
+
+	/** What the server's Execute path will do with Command, without side effects. */
+	void SimulateCommand(FGE_WeaponPredictedState& State, const FGE_WeaponCommand& Command) const;
+
+protected:
+	/** Marks NetState dirty after a change to ChangedFields and runs the same reactions a replicated update would. */
+	void CommitState(EGE_WeaponStateField ChangedFields, int32 OldTotalAmmo = INDEX_NONE);
+
+	/** Local reactions to each changed field, then a single OnWeaponStateChanged. */
+	void DispatchStateChanged(EGE_WeaponStateField ChangedFields, int32 OldTotalAmmo = INDEX_NONE);
+
 	UFUNCTION()
-	void OnRep_AmmoInMag();
-	
-	UFUNCTION()
-	void OnRep_TotalAmmo(int32 OldTotalAmmo);
-	
-	UFUNCTION()
-	void OnRep_IsFiring();
-	
-	UFUNCTION()
-	void OnRep_IsReloading();
-	
-	UFUNCTION()
-	void OnRep_IsAiming();
-	
-	UFUNCTION()
-	void OnRep_BulletData();
-	
+	void OnRep_NetState();
+
 	UFUNCTION()
-	void OnRep_FireMode();
+	void OnRep_AckedCommandSequence();
 
 };
@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Interface.h"
+#include "Misc/GE_Types.h"
 #include "GE_CharacterInterface.generated.h"
 
 class AGE_Equipment;
+class AGE_FireWeapon;
 
 UINTERFACE(MinimalAPI)
 class UGE_CharacterInterface : public UInterface
@@ -30,4 +32,9 @@ public:
 
 	virtual bool ShouldUseRunFireDelay() const { return false; }
 
+	virtual EGE_DamageZone GetDamageZoneForBone(FName BoneName) const { return EGE_DamageZone::Generic; }
+
+	/** Every shot on every machine, ShotIndex counts shots since the trigger was pressed. */
+	virtual void OnWeaponFired(AGE_FireWeapon* Weapon, uint16 ShotSequence, int32 ShotIndex) {}
+
 };
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Curves/CurveFloat.h"
+#include "Misc/GE_Types.h"
+#include "GE_DamageProfileData.generated.h"
+
+USTRUCT(BlueprintType)
+struct FGE_DamageProfile
+{
+	GENERATED_BODY()
+
+	// Damage kept over distance, X in cm. Past the last key the last value holds, no keys keeps full damage
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FRuntimeFloatCurve RangeFalloff;
+
+	// Distance the falloff table spans, in cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=100.0, Units="Centimeters"))
+	float MaxRange = 10000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0))
+	float HeadMultiplier = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0))
+	float TorsoMultiplier = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0))
+	float ArmsMultiplier = 0.8f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0))
+	float LegsMultiplier = 0.8f;
+
+	// Damage kept against the victim's armor, X in armor points. No keys ignores armor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FRuntimeFloatCurve ArmorMitigation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=1.0))
+	float MaxArmor = 100.0f;
+};
+
+/** DamageProfile sampled at fixed steps, so a hit costs a few reads and a lerp instead of curve evaluations. */
+struct GAMEPLAYEQUIPMENTS_API FGE_DamageLUT
+{
+	static constexpr int32 RangeSize = 64;
+	static constexpr int32 ArmorSize = 32;
+	static constexpr int32 NumZones = static_cast<int32>(EGE_DamageZone::Legs) + 1;
+
+	float Range[RangeSize];
+	float Armor[ArmorSize];
+	float Zones[NumZones];
+	float RangeToIndex = 0.f;
+	float ArmorToIndex = 0.f;
+
+	FGE_DamageLUT();
+
+	void Bake(const FGE_DamageProfile& Profile);
+
+	float GetRangeScale(float Distance) const { return Sample(Range, RangeSize, Distance * RangeToIndex); }
+	float GetArmorScale(float ArmorPoints) const { return Sample(Armor, ArmorSize, ArmorPoints * ArmorToIndex); }
+	float GetZoneScale(EGE_DamageZone Zone) const { return Zones[static_cast<int32>(Zone)]; }
+
+	/** Range and zone, what the weapon knows about a hit. Armor is applied by the victim. */
+	float GetHitScale(float Distance, EGE_DamageZone Zone) const { return GetRangeScale(Distance) * GetZoneScale(Zone); }
+
+private:
+	static float Sample(const float* Table, int32 Size, float Position)
+	{
+		const float Clamped = FMath::Clamp(Position, 0.f, static_cast<float>(Size - 1));
+		const int32 Index = FMath::Min(static_cast<int32>(Clamped), Size - 2);
+		return FMath::Lerp(Table[Index], Table[Index + 1], Clamped - Index);
+	}
+};
+
+UCLASS(Blueprintable, BlueprintType)
+class GAMEPLAYEQUIPMENTS_API UGE_DamageProfileData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	//~ UObject
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~ End of UObject
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Defaults)
+	FGE_DamageProfile Profile;
+
+	const FGE_DamageLUT& GetLUT() const { return LUT; }
+
+	/** Rebuilds the tables from Profile, for profiles changed at runtime. */
+	void Bake() { LUT.Bake(Profile); }
+
+private:
+	FGE_DamageLUT LUT;
+};
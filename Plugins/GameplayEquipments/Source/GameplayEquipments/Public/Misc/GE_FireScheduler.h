@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fire cadence independent of the tick rate. Shot times are Start + N * Interval,
+ * so any number of shots can come due in one frame and none drift or get dropped.
+ */
+struct GAMEPLAYEQUIPMENTS_API FGE_FireScheduler
+{
+	using FShotTimes = TArray<double, TInlineAllocator<8>>;
+
+	/** First shot is due at StartTime. */
+	void Start(double StartTime, double InInterval);
+	void Stop();
+
+	bool IsActive() const { return bActive; }
+	double GetInterval() const { return Interval; }
+
+	/** Appends the time of every shot due up to and including Now. */
+	int32 Advance(double Now, FShotTimes& OutShotTimes);
+
+private:
+	double StartTime = 0.0;
+	double Interval = 0.1;
+	int64 NextShot = 0;
+	bool bActive = false;
+};
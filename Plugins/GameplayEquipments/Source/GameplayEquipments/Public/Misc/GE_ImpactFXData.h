@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/EngineTypes.h"
+#include "GE_ImpactFXData.generated.h"
+
+class UNiagaraSystem;
+class USoundBase;
+class UMaterialInterface;
+
+USTRUCT(BlueprintType)
+struct FGE_ImpactFX
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	TObjectPtr<UNiagaraSystem> Effect;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	TObjectPtr<USoundBase> Sound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	TObjectPtr<UMaterialInterface> DecalMaterial;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FVector DecalSize = FVector(4.0, 6.0, 6.0);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0))
+	float DecalLifetime = 10.0f;
+};
+
+UCLASS(Blueprintable, BlueprintType)
+class GAMEPLAYEQUIPMENTS_API UGE_ImpactFXData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FGE_ImpactFX Default;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	TMap<TEnumAsByte<EPhysicalSurface>, FGE_ImpactFX> Surfaces;
+
+	// Niagara instances preallocated for each effect, surfaces with the same effect share them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=1))
+	int32 EffectsPerSurface = 8;
+
+public:
+	const FGE_ImpactFX& GetImpactFX(EPhysicalSurface SurfaceType) const
+	{
+		const FGE_ImpactFX* Found = Surfaces.Find(SurfaceType);
+		return Found ? *Found : Default;
+	}
+};
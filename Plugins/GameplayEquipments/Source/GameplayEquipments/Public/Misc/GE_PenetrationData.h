@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/EngineTypes.h"
+#include "CollisionQueryParams.h"
+#include "Misc/GE_Types.h"
+#include "GE_PenetrationData.generated.h"
+
+USTRUCT(BlueprintType)
+struct FGE_SurfacePenetration
+{
+	GENERATED_BODY()
+
+	// Thickest section a bullet can pass through, in cm. 0 stops every bullet
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0))
+	float PenetrationDepth = 0.0f;
+
+	// Damage kept after passing through
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0, ClampMax=1.0))
+	float DamageRetention = 0.5f;
+
+	// Bullets hitting at or below this angle from the surface bounce off. 0 never ricochets
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0, ClampMax=90.0, Units="Degrees"))
+	float RicochetAngle = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.0, ClampMax=1.0))
+	float RicochetDamageRetention = 0.3f;
+};
+
+UCLASS(Blueprintable, BlueprintType)
+class GAMEPLAYEQUIPMENTS_API UGE_PenetrationData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	FGE_SurfacePenetration Default;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	TMap<TEnumAsByte<EPhysicalSurface>, FGE_SurfacePenetration> Surfaces;
+
+	// Surfaces a single pellet can damage, including the one it stops in
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=1, ClampMax=8))
+	int32 MaxSurfaces = 3;
+
+public:
+	const FGE_SurfacePenetration& GetSurface(EPhysicalSurface SurfaceType) const
+	{
+		const FGE_SurfacePenetration* Found = Surfaces.Find(SurfaceType);
+		return Found ? *Found : Default;
+	}
+
+	/**
+	 * Walks the entry hits of one pellet, nearest first, and outputs the surfaces it damages with their DamageScale.
+	 * Thickness comes from a single reverse probe shared by every surface, a ricochet spends that same probe.
+	 * Returns the number of queries issued, never more than one.
+	 */
+	int32 ResolvePellet(const UWorld* World, const FVector& Start, const FVector& End, ECollisionChannel Channel, const FCollisionQueryParams& Params,
+		TConstArrayView<FGE_ShotHit> Entries, TArray<FGE_ShotHit>& OutHits) const;
+
+	/** Query responses that turn blocking surfaces into touches, so one multi trace returns every entry along the pellet. */
+	static const FCollisionResponseParams& GetEntryResponseParams();
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("GameplayEquipments"), STATGROUP_GameplayEquipments, STATCAT_Advanced);
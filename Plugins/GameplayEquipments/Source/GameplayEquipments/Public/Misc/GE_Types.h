@@ -1,9 +1,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+#include "Engine/DamageEvents.h"
 
 #include "GE_Types.generated.h"
 
+class UMaterialInterface;
+
 UENUM(BlueprintType)
 enum class EGE_EquipmentRemovalReason : uint8
 {
@@ -11,6 +16,83 @@ enum class EGE_EquipmentRemovalReason : uint8
 	OwnerDeath
 };
 
+UENUM(BlueprintType)
+enum class EGE_DamageZone : uint8
+{
+	Generic,
+	Head,
+	Torso,
+	Arms,
+	Legs
+};
+
+/** Everything the weapon needs from a shot hit, resolved from a single trace. */
+USTRUCT(BlueprintType)
+struct FGE_ShotHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	FHitResult Hit;
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	TObjectPtr<UMaterialInterface> FaceMaterial = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	FName BoneName = NAME_None;
+
+	// BoneName in the skeleton of the hit component, INDEX_NONE when it isn't skinned
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	int32 BoneIndex = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	EGE_DamageZone DamageZone = EGE_DamageZone::Generic;
+
+	// Damage left after penetrating or ricocheting off earlier surfaces
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	float DamageScale = 1.0f;
+
+	// Distance the bullet covered from the muzzle, in cm
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	float Range = 0.0f;
+
+	bool IsValidBlockingHit() const { return Hit.IsValidBlockingHit(); }
+
+	/** Expects a trace made with bReturnPhysicalMaterial and bReturnFaceIndex. */
+	static FGE_ShotHit Resolve(const FHitResult& InHit);
+};
+
+/**
+ * Every pellet of one shot, identified by ShotSequence, that hit the same actor, applied as a single point damage event.
+ * Damage is the sum of GetPelletDamage over every pellet, so penetration, range and zone scaling are already in it.
+ * Receivers that weight pellets themselves should start from GetPelletDamage. HitInfo and ShotDirection come from the first pellet.
+ */
+USTRUCT()
+struct FGE_ShotDamageEvent : public FPointDamageEvent
+{
+	GENERATED_BODY()
+
+	// Damage of a pellet before its DamageScale, the weapon's base damage
+	UPROPERTY()
+	float PelletDamage = 0.f;
+
+	UPROPERTY()
+	TArray<FGE_ShotHit> PelletHits;
+
+	UPROPERTY()
+	uint16 ShotSequence = 0;
+
+	static const int32 ClassID = 0x47455344;
+
+	virtual int32 GetTypeID() const override { return FGE_ShotDamageEvent::ClassID; }
+	virtual bool IsOfType(int32 InID) const override { return FGE_ShotDamageEvent::ClassID == InID || FPointDamageEvent::IsOfType(InID); }
+
+	float GetPelletDamage(int32 Index) const { return PelletDamage * PelletHits[Index].DamageScale; }
+};
+
 USTRUCT(BlueprintType)
 struct FDualAnimMontageData
 {
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GE_EquipmentPoolSubsystem.generated.h"
+
+class AGE_Equipment;
+class ACharacter;
+
+USTRUCT()
+struct FGE_EquipmentPoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AGE_Equipment>> Parked;
+};
+
+struct FGE_EquipmentPoolCounters
+{
+	int32 Hits = 0;
+	int32 Misses = 0;
+	int32 Destroyed = 0;
+};
+
+/**
+ * Server side equipment actors keyed by class. Released equipment is reset, detached and parked dormant,
+ * so a respawn wave hands back existing actors instead of spawning new ones and leaving the old ones to GC.
+ */
+UCLASS()
+class GAMEPLAYEQUIPMENTS_API UGE_EquipmentPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+public:
+	/** A parked instance of Class given to NewOwner, or a new one when none is parked. Authority only. */
+	AGE_Equipment* AcquireOrSpawn(TSubclassOf<AGE_Equipment> Class, const FTransform& SpawnTransform, ACharacter* NewOwner);
+
+	/** Resets and parks Equipment. Returns false when its class is at capacity, the caller disposes of it then. */
+	bool Release(AGE_Equipment* Equipment);
+
+	/** Equipment leaving play, counted towards the destroyed rate and dropped from the pool. */
+	void NotifyEquipmentDestroyed(AGE_Equipment* Equipment);
+
+	int32 GetNumParked() const;
+
+	const FGE_EquipmentPoolCounters& GetTotalCounters() const { return Total; }
+
+	/** The last full minute, or the running one before the first has ended. */
+	const FGE_EquipmentPoolCounters& GetCountersPerMinute() const { return bHasFullMinute ? LastMinute : CurrentMinute; }
+
+protected:
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<AGE_Equipment>, FGE_EquipmentPoolBucket> Buckets;
+
+	FGE_EquipmentPoolCounters Total;
+	FGE_EquipmentPoolCounters CurrentMinute;
+	FGE_EquipmentPoolCounters LastMinute;
+	double MinuteStartTime = 0.0;
+	bool bHasFullMinute = false;
+
+	void RollMinute();
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "Misc/GE_Types.h"
+#include "GE_HitscanSubsystem.generated.h"
+
+class AGE_FireWeapon;
+
+/**
+ * Collects hitscan traces from every weapon during the frame and issues them as async traces in one pass.
+ * Results are polled on the following frame and handed back to the weapon that queued them.
+ */
+UCLASS()
+class GAMEPLAYEQUIPMENTS_API UGE_HitscanSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End of FTickableGameObject
+
+public:
+	/** Queues a single pellet trace of shot ShotSequence. RewindTimestamp >= 0 resolves characters through lag compensation. */
+	void QueueTrace(AGE_FireWeapon* Weapon, uint16 ShotSequence, const FVector& Start, const FVector& End, ECollisionChannel Channel, double RewindTimestamp = -1.0);
+
+	int32 GetNumPending() const { return Pending.Num(); }
+	int32 GetNumInFlight() const { return InFlight.Num(); }
+
+protected:
+	struct FBatch
+	{
+		TArray<TWeakObjectPtr<AGE_FireWeapon>> Weapons;
+		TArray<uint16> ShotSequences;
+		TArray<FVector> Starts;
+		TArray<FVector> Ends;
+		TArray<TEnumAsByte<ECollisionChannel>> Channels;
+		TArray<double> RewindTimes;
+		TArray<double> QueueTimes;
+		TArray<FTraceHandle> Handles;
+
+		int32 Num() const { return Weapons.Num(); }
+
+		void Reserve(int32 Count);
+		void Reset();
+		void Move(int32 From, int32 To);
+		void Truncate(int32 Count);
+		int32 Append(const FBatch& Other, int32 Index);
+	};
+
+	FBatch Pending;
+	FBatch InFlight;
+
+	// Scratch for penetrating pellets
+	TArray<FGE_ShotHit> Entries;
+	TArray<FGE_ShotHit> Hits;
+
+	// Weapons with shot damage queued during this resolve pass
+	TArray<TWeakObjectPtr<AGE_FireWeapon>> DamagedWeapons;
+
+	void IssuePending();
+	void ResolveInFlight();
+	void ResolvePenetration(AGE_FireWeapon* Weapon, int32 Index, const FTraceDatum& Datum);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Misc/GE_Types.h"
+#include "GE_ImpactFXSubsystem.generated.h"
+
+class UGE_ImpactFXData;
+class UNiagaraComponent;
+class UNiagaraSystem;
+class UDecalComponent;
+class UAudioComponent;
+
+USTRUCT()
+struct FGE_ImpactEffectPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<UNiagaraComponent>> Components;
+
+	TArray<double> LastUsed;
+};
+
+/**
+ * Preallocated impact decals, Niagara effects and sounds shared by every weapon in the world.
+ * Once warm, spawning an impact only moves and restarts existing components, the least recently used one is recycled when a pool is full.
+ */
+UCLASS()
+class GAMEPLAYEQUIPMENTS_API UGE_ImpactFXSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End of FTickableGameObject
+
+public:
+	/** Allocates every pool Data can need. Safe to call more than once. */
+	void Prewarm(const UGE_ImpactFXData* Data);
+
+	/** Whether an impact anywhere along Start to End could be seen or heard, so shots that cannot are not worth tracing for FX. */
+	bool IsShotInRange(const FVector& Start, const FVector& End) const;
+
+	/** Returns false when everything was culled or over budget. */
+	bool SpawnImpact(const UGE_ImpactFXData* Data, const FGE_ShotHit& ShotHit);
+
+protected:
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> PoolOwner;
+
+	// Keyed by system, so every component in a pool already has its asset and surfaces sharing one share the pool
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UNiagaraSystem>, FGE_ImpactEffectPool> EffectPools;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UDecalComponent>> Decals;
+	TArray<double> DecalLastUsed;
+	TArray<double> DecalExpireTimes;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UAudioComponent>> Sounds;
+	TArray<double> SoundLastUsed;
+
+	int32 EffectsThisFrame = 0;
+	int32 DecalsThisFrame = 0;
+	int32 SoundsThisFrame = 0;
+
+	FVector ViewLocation = FVector::ZeroVector;
+	FVector ViewDirection = FVector::ForwardVector;
+	float ViewCosHalfFOV = -1.f;
+	bool bHasView = false;
+
+	void RefreshView();
+
+	bool IsInView(const FVector& Location, bool bRequireFrustum) const;
+
+	static int32 FindLeastRecentlyUsed(const TArray<double>& LastUsed);
+
+	UNiagaraComponent* AcquireEffect(UNiagaraSystem* System, int32 PoolSize, double Now);
+	int32 AcquireDecal(double Now);
+	UAudioComponent* AcquireSound(double Now);
+
+	void EnsurePoolOwner();
+	void EnsureEffectPool(UNiagaraSystem* System, int32 PoolSize);
+};
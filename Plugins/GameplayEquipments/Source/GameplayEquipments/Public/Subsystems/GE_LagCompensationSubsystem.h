@@ -0,0 +1,148 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Misc/GE_Types.h"
+#include "GE_LagCompensationSubsystem.generated.h"
+
+class ACharacter;
+class APawn;
+class USkeletalMeshComponent;
+class UPhysicalMaterial;
+struct FCollisionQueryParams;
+
+enum class EGE_HitboxShapeType : uint8
+{
+	Sphere,
+	Capsule,
+	Box
+};
+
+/** Collision primitive baked from a physics asset body, expressed relative to its bone. */
+struct FGE_HitboxShape
+{
+	FTransform LocalTransform = FTransform::Identity;
+
+	// Sphere: X = radius. Capsule: X = radius, Z = half segment length. Box: half extents.
+	FVector3f Extent = FVector3f::ZeroVector;
+
+	int32 BoneIndex = INDEX_NONE;
+	FName BoneName = NAME_None;
+
+	TWeakObjectPtr<UPhysicalMaterial> PhysMaterial;
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	EGE_DamageZone DamageZone = EGE_DamageZone::Generic;
+	EGE_HitboxShapeType Type = EGE_HitboxShapeType::Sphere;
+
+	float GetBoundingRadius() const;
+};
+
+struct FGE_HitboxSample
+{
+	FVector3f Location = FVector3f::ZeroVector;
+	FQuat4f Rotation = FQuat4f::Identity;
+};
+
+struct FGE_HitboxRaycastResult
+{
+	float Distance = 0.f;
+	int32 ShapeIndex = INDEX_NONE;
+	FVector Normal = FVector::UpVector;
+};
+
+/**
+ * Fixed-size ring buffer of world space hitbox poses for one character.
+ * All storage is allocated in Init, recording and rewinding never allocate.
+ */
+class GAMEPLAYEQUIPMENTS_API FGE_HitboxHistory
+{
+public:
+	void Init(TArray<FGE_HitboxShape>&& InShapes, int32 InCapacity);
+	void Reset();
+
+	/** Records a new frame, GetBoneWorldTransform receives a bone index and must return its world transform. */
+	void Record(double Time, TFunctionRef<FTransform(int32)> GetBoneWorldTransform);
+
+	/** Raycasts the pose interpolated at Time. Dir must be normalized. */
+	bool Raycast(const FVector& Start, const FVector& Dir, float MaxDistance, double Time, FGE_HitboxRaycastResult& OutResult) const;
+
+	const TArray<FGE_HitboxShape>& GetShapes() const { return Shapes; }
+
+	int32 GetNumShapes() const { return Shapes.Num(); }
+	int32 GetNumFrames() const { return NumFrames; }
+	int32 GetCapacity() const { return Capacity; }
+
+	double GetNewestTime() const;
+	double GetOldestTime() const;
+
+private:
+	int32 GetSlot(int32 Age) const { return (Head - Age + Capacity) % Capacity; }
+
+	void FindFrames(double Time, int32& OutSlotA, int32& OutSlotB, float& OutAlpha) const;
+
+	static bool RaycastShape(const FGE_HitboxShape& Shape, const FVector& Location, const FQuat& Rotation, const FVector& Start, const FVector& Dir, float& OutDistance, FVector& OutNormal);
+
+	TArray<FGE_HitboxShape> Shapes;
+
+	// Flat [Capacity * NumShapes] pose storage, slot major.
+	TArray<FGE_HitboxSample> Samples;
+	TArray<double> Times;
+	TArray<FVector4f> Bounds; // XYZ = center, W = radius
+
+	int32 Capacity = 0;
+	int32 Head = INDEX_NONE;
+	int32 NumFrames = 0;
+};
+
+UCLASS()
+class GAMEPLAYEQUIPMENTS_API UGE_LagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End of FTickableGameObject
+
+public:
+	/** Starts recording hitboxes from the character mesh physics asset. Authority only. */
+	void RegisterCharacter(ACharacter* Character);
+	void UnregisterCharacter(ACharacter* Character);
+
+	/** Makes scene queries ignore the live pose of tracked characters, so the rewound pose is the only one hit. */
+	void AddTrackedActorsToQuery(FCollisionQueryParams& Params) const;
+
+	/** Traces against every tracked character as it was at Timestamp (server world time). Surface and damage zone come from the baked hitbox. */
+	bool TraceRewound(const FVector& Start, const FVector& End, double Timestamp, const AActor* IgnoreActor, FGE_ShotHit& OutShotHit) const;
+
+	/** Clamps a client provided timestamp to the window the history can rewind. */
+	double ClampRewindTime(double Timestamp) const;
+
+	/** Server world time of the world state a locally controlled pawn is currently looking at. */
+	static double GetViewTimestamp(const APawn* Viewer);
+
+	int32 GetNumTracked() const { return Tracked.Num(); }
+
+protected:
+	struct FTrackedCharacter
+	{
+		TWeakObjectPtr<ACharacter> Character;
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		FGE_HitboxHistory History;
+	};
+
+	TArray<FTrackedCharacter> Tracked;
+
+	// Same actors as Tracked, kept contiguous for collision query ignore lists.
+	TArray<const AActor*> TrackedActors;
+
+	static bool BuildShapes(const USkeletalMeshComponent* Mesh, TArray<FGE_HitboxShape>& OutShapes);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "GE_ProjectileSubsystem.generated.h"
+
+class AGE_FireWeapon;
+
+/**
+ * Ballistic bullets without actors. Every live bullet is a row in a set of parallel arrays,
+ * integrated with gravity and drag in a ParallelFor and swept one segment per tick with async traces.
+ * Segment results are read on the next tick, hits go back to the weapon that fired.
+ */
+UCLASS()
+class GAMEPLAYEQUIPMENTS_API UGE_ProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End of FTickableGameObject
+
+public:
+	/**
+	 * Cosmetic bullets only spawn impact effects, the others apply damage through the weapon.
+	 * RewindTimestamp >= 0 resolves characters through lag compensation at RewindTimestamp plus the bullet age.
+	 */
+	void Launch(AGE_FireWeapon* Weapon, uint16 ShotSequence, const FVector& Start, const FVector& Velocity, double RewindTimestamp, bool bCosmetic);
+
+	int32 GetNumLive() const { return Weapons.Num(); }
+
+protected:
+	TArray<TWeakObjectPtr<AGE_FireWeapon>> Weapons;
+	TArray<uint16> ShotSequences;
+	TArray<FVector> Origins;
+	TArray<FVector> Positions;
+	TArray<FVector> PrevPositions;
+	TArray<FVector> Velocities;
+	TArray<float> GravityZs;
+	TArray<float> Drags;
+	TArray<float> Ages;
+	TArray<float> Lifetimes;
+	TArray<double> RewindTimes;
+	TArray<TEnumAsByte<ECollisionChannel>> Channels;
+	TArray<uint8> CosmeticFlags;
+	TArray<FTraceHandle> Handles;
+
+	// Scratch, kept to avoid reallocating every tick
+	TArray<int32> Removals;
+	TArray<TWeakObjectPtr<AGE_FireWeapon>> DamagedWeapons;
+
+	void ResolveTraces();
+	void Integrate(float DeltaTime);
+	void IssueTraces();
+
+	void RemoveAtSwap(int32 Index);
+};
@@ -4,15 +4,27 @@
 #include "Net/UnrealNetwork.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "Engine/AssetManager.h"
+#include "Engine/DamageEvents.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/ScopeExit.h"
 
 #include "Components/FPS_HealthComponent.h"
 #include "Misc/GL_GameplayTags.h"
 #include "Game/FPS_GameMode.h"
+#include "Game/FPS_RadialDamageSubsystem.h"
+#include "Game/FPS_SignificanceSubsystem.h"
 #include "Components/GE_EquipmentManagerComponent.h"
 #include "Equipments/GE_Equipment.h"
+#include "Equipments/GE_FireWeapon.h"
 #include "Misc/GE_EquipmentAnimData.h"
+#include "Subsystems/GE_LagCompensationSubsystem.h"
+#include "Subsystems/GE_EquipmentPoolSubsystem.h"
 #include "Camera/FPS_CameraComponent.h"
 #include "Animation/FPS_AnimInstance.h"
+#include "Components/GA_RecoilComponent.h"
+#include "Misc/GA_RecoilData.h"
 
 AFPS_Character::AFPS_Character(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -46,6 +58,15 @@ AFPS_Character::AFPS_Character(const FObjectInitializer& ObjectInitializer)
 	EquipmentManager = CreateDefaultSubobject<UGE_EquipmentManagerComponent>(TEXT("EquipmentManager"));
 
 	ViewMode = GameplayViewModeTags::FirstPerson;
+
+	DamageZoneBones = {
+		{ TEXT("spine_01"), EGE_DamageZone::Torso },
+		{ TEXT("head"), EGE_DamageZone::Head },
+		{ TEXT("upperarm_l"), EGE_DamageZone::Arms },
+		{ TEXT("upperarm_r"), EGE_DamageZone::Arms },
+		{ TEXT("thigh_l"), EGE_DamageZone::Legs },
+		{ TEXT("thigh_r"), EGE_DamageZone::Legs }
+	};
 }
 
 void AFPS_Character::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -53,6 +74,10 @@ void AFPS_Character::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(AFPS_Character, EquipmentsCount);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AFPS_Character, DeathEvent, Params);
 }
 
 void AFPS_Character::PreInitializeComponents()
@@ -74,12 +99,52 @@ void AFPS_Character::PostInitializeComponents()
 void AFPS_Character::BeginPlay()
 {
 	Super::BeginPlay();
+
+	BuildBoneDamageZones();
+
+	RecoilComponent = FindComponentByClass<UGA_RecoilComponent>();
+
+	Significance = GetWorld()->GetSubsystem<UFPS_SignificanceSubsystem>();
+	if (Significance.IsValid())
+	{
+		Significance->RegisterCharacter(this);
+	}
+
+	if (HasAuthority())
+	{
+		if (UGE_LagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UGE_LagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterCharacter(this);
+		}
+
+		if (UFPS_RadialDamageSubsystem* RadialDamage = GetWorld()->GetSubsystem<UFPS_RadialDamageSubsystem>())
+		{
+			RadialDamage->RegisterCharacter(this);
+		}
+	}
 }
 
 void AFPS_Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	GetWorldTimerManager().ClearAllTimersForObject(this);
 
+	CancelPendingLoadout();
+
+	if (UGE_LagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UGE_LagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterCharacter(this);
+	}
+
+	if (UFPS_RadialDamageSubsystem* RadialDamage = GetWorld()->GetSubsystem<UFPS_RadialDamageSubsystem>())
+	{
+		RadialDamage->UnregisterCharacter(this);
+	}
+
+	if (Significance.IsValid())
+	{
+		Significance->UnregisterCharacter(this);
+	}
+
 	if (IsValid(HealthComponent))
 	{
 		HealthComponent->OnDeathPayload.RemoveDynamic(this, &AFPS_Character::HandleDeathPayload);
@@ -97,6 +162,15 @@ void AFPS_Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 void AFPS_Character::Tick(float DeltaTime)
 {
+	const double StartTime = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT
+	{
+		if (Significance.IsValid())
+		{
+			Significance->AddTickCost(FPlatformTime::Seconds() - StartTime);
+		}
+	};
+
 	Super::Tick(DeltaTime);
 
 	if (AGE_Equipment* CurrentEquipment = GetCurrentEquipment())
@@ -137,6 +211,23 @@ void AFPS_Character::Tick(float DeltaTime)
 	}
 }
 
+float AFPS_Character::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	// The damage delegates would drop the pellets and apply the hit twice, and radial damage from the subsystem
+	// is already final. Both go to the health component whole
+	if (DamageEvent.IsOfType(FGE_ShotDamageEvent::ClassID) || DamageEvent.IsOfType(FFPS_RadialDamageEvent::ClassID))
+	{
+		const float ActualDamage = HealthComponent ? HealthComponent->ApplyDamageEvent(DamageAmount, DamageEvent, EventInstigator, DamageCauser) : 0.f;
+		if (ActualDamage != 0.f && EventInstigator)
+		{
+			EventInstigator->InstigatedAnyDamage(ActualDamage, DamageEvent.DamageTypeClass.GetDefaultObject(), this, DamageCauser);
+		}
+		return ActualDamage;
+	}
+
+	return Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+}
+
 void AFPS_Character::BecomeViewTarget(APlayerController* PC)
 {
 	Super::BecomeViewTarget(PC);
@@ -317,6 +408,47 @@ bool AFPS_Character::ShouldUseRunFireDelay() const
 		(Gait.MatchesTagExact(GameplayGaitTags::Running) || Gait.MatchesTagExact(GameplayGaitTags::Sprinting));
 }
 
+EGE_DamageZone AFPS_Character::GetDamageZoneForBone(FName BoneName) const
+{
+	const int32 BoneIndex = GetMesh()->GetBoneIndex(BoneName);
+	return BoneDamageZones.IsValidIndex(BoneIndex) ? BoneDamageZones[BoneIndex] : EGE_DamageZone::Generic;
+}
+
+void AFPS_Character::OnWeaponFired(AGE_FireWeapon* Weapon, uint16 ShotSequence, int32 ShotIndex)
+{
+	if (!RecoilComponent || !Weapon) return;
+
+	RecoilComponent->SetRecoilPreset(Cast<UGA_RecoilData>(Weapon->RecoilPattern));
+	RecoilComponent->PlayRecoil(ShotSequence, ShotIndex);
+}
+
+void AFPS_Character::BuildBoneDamageZones()
+{
+	BoneDamageZones.Reset();
+
+	const USkinnedAsset* SkinnedAsset = GetMesh()->GetSkinnedAsset();
+	if (!SkinnedAsset) return;
+
+	const FReferenceSkeleton& RefSkeleton = SkinnedAsset->GetRefSkeleton();
+	BoneDamageZones.Init(EGE_DamageZone::Generic, RefSkeleton.GetNum());
+
+	// Parents always come before their children, so a single pass inherits the closest listed ancestor
+	for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetNum(); ++BoneIndex)
+	{
+		if (const EGE_DamageZone* Zone = DamageZoneBones.Find(RefSkeleton.GetBoneName(BoneIndex)))
+		{
+			BoneDamageZones[BoneIndex] = *Zone;
+			continue;
+		}
+
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		if (ParentIndex != INDEX_NONE)
+		{
+			BoneDamageZones[BoneIndex] = BoneDamageZones[ParentIndex];
+		}
+	}
+}
+
 void AFPS_Character::PopulateLoadout(const FPlayerLoadout& PlayerLoadout)
 {
 	if (!HasAuthority()) return;
@@ -325,62 +457,116 @@ void AFPS_Character::PopulateLoadout(const FPlayerLoadout& PlayerLoadout)
 
 	if (!EquipmentManager) return;
 
-	TArray<TSoftClassPtr<AGE_Equipment>> CheckedClasses = PlayerLoadout.Equipments.FilterByPredicate([](const TSoftClassPtr<AGE_Equipment>& InSoftClass)
+	CancelPendingLoadout();
+
+	PendingLoadout = PlayerLoadout.Equipments.FilterByPredicate([](const TSoftClassPtr<AGE_Equipment>& InSoftClass)
 	{
 		return !InSoftClass.IsNull();
 	});
 
+	EquipmentsCount = 0;
+	EquipmentsSpawned = 0;
+
+	if (PendingLoadout.Num() <= 0) return;
+
+	if (AFPS_GameMode* GM = GetWorld()->GetAuthGameMode<AFPS_GameMode>())
+	{
+		GM->NotifyLoadoutRequested();
+	}
+
+	TArray<FSoftObjectPath> PendingPaths;
+	for (const TSoftClassPtr<AGE_Equipment>& InSoftClass : PendingLoadout)
+	{
+		if (!InSoftClass.Get())
+		{
+			PendingPaths.Add(InSoftClass.ToSoftObjectPath());
+		}
+	}
+
+	// Preloaded by the game mode in the common case, spawn in this frame
+	if (PendingPaths.Num() == 0)
+	{
+		SpawnPendingLoadout();
+		return;
+	}
+
+	LoadoutHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(PendingPaths,
+		FStreamableDelegate::CreateUObject(this, &AFPS_Character::SpawnPendingLoadout), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void AFPS_Character::SpawnPendingLoadout()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
 	TArray<TSubclassOf<AGE_Equipment>> ValidClasses;
-	ValidClasses.Reserve(CheckedClasses.Num());
+	ValidClasses.Reserve(PendingLoadout.Num());
 
-	for (const TSoftClassPtr<AGE_Equipment>& InSoftClass : CheckedClasses)
+	for (const TSoftClassPtr<AGE_Equipment>& InSoftClass : PendingLoadout)
 	{
-		if (TSubclassOf<AGE_Equipment> EquipementClass = InSoftClass.LoadSynchronous())
+		if (TSubclassOf<AGE_Equipment> EquipementClass = InSoftClass.Get())
 		{
 			ValidClasses.Add(EquipementClass);
 		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to load equipment class %s"), *InSoftClass.ToString());
+		}
 	}
 
+	PendingLoadout.Reset();
+	LoadoutHandle.Reset();
+
 	EquipmentsCount = ValidClasses.Num();
 	EquipmentsSpawned = 0;
 
-	if (EquipmentsCount <= 0) return;
-
 	const FTransform SpawnTransform(FRotator::ZeroRotator, FVector(0.0f, 0.0f, -50000.0f), FVector::OneVector);
 
+	UGE_EquipmentPoolSubsystem* EquipmentPool = GetWorld()->GetSubsystem<UGE_EquipmentPoolSubsystem>();
+
 	for (int32 i = 0; i < EquipmentsCount; ++i)
 	{
 		TSubclassOf<AGE_Equipment> EquipmentClass = ValidClasses[i];
 		if (!EquipmentClass) continue;
 
-		AGE_Equipment* SpawnedEquipment = GetWorld()->SpawnActorDeferred<AGE_Equipment>(EquipmentClass, SpawnTransform, this, this, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		// Equipment released by the dead gets handed back here, a new actor is spawned only on a pool miss
+		AGE_Equipment* SpawnedEquipment = EquipmentPool ? EquipmentPool->AcquireOrSpawn(EquipmentClass, SpawnTransform, this) : nullptr;
 
 		if (!SpawnedEquipment)
 		{
-			if (++EquipmentsSpawned == EquipmentsCount)
-			{
-				// #TODO
-				return;
-			}
-
+			++EquipmentsSpawned;
 			continue;
 		}
 
-		SpawnedEquipment->SetOwningCharacter(this);
-
-		SpawnedEquipment->FinishSpawning(SpawnTransform);
-
 		const int32 SlotIndex = EquipmentManager->AddEquipment(SpawnedEquipment, i);
 		if (SlotIndex == INDEX_NONE)
 		{
 			UE_LOG(LogTemp, Warning, TEXT("Failed to add equipment %s to slot %i"), *GetNameSafe(SpawnedEquipment), SlotIndex);
 		}
 
-		if (++EquipmentsSpawned == EquipmentsCount)
-		{
-			// #TODO
-			return;
-		}
+		++EquipmentsSpawned;
+	}
+
+	if (AFPS_GameMode* GM = GetWorld()->GetAuthGameMode<AFPS_GameMode>())
+	{
+		GM->NotifyLoadoutFinished(FPlatformTime::Seconds() - StartTime);
+	}
+}
+
+void AFPS_Character::CancelPendingLoadout()
+{
+	if (PendingLoadout.Num() == 0) return;
+
+	if (LoadoutHandle.IsValid())
+	{
+		LoadoutHandle->CancelHandle();
+		LoadoutHandle.Reset();
+	}
+
+	PendingLoadout.Reset();
+
+	if (AFPS_GameMode* GM = GetWorld()->GetAuthGameMode<AFPS_GameMode>())
+	{
+		GM->NotifyLoadoutFinished(0.0);
 	}
 }
 
@@ -392,6 +578,19 @@ void AFPS_Character::HandleDeathPayload(const FDeathEventPayload& Data)
 		// GM->OnCharacterDied(this, Data.InstigatorController, KillData);
 	}
 
+	// Stays on the ragdoll for a while, then goes back to the pool for the next respawn wave. The manager releases whatever is left on destroy
+	if (HasAuthority() && EquipmentManager && EquipmentReleaseDelay >= 0.f)
+	{
+		FTimerHandle ReleaseTh;
+		GetWorldTimerManager().SetTimer(ReleaseTh, FTimerDelegate::CreateWeakLambda(this, [this]
+		{
+			if (EquipmentManager)
+			{
+				EquipmentManager->RemoveEquipments(EGE_EquipmentRemovalReason::OwnerDeath);
+			}
+		}), FMath::Max(EquipmentReleaseDelay, KINDA_SMALL_NUMBER), false);
+	}
+
 	if (GetNetMode() == NM_DedicatedServer)
 	{
 		FTimerHandle StopTickTh;
@@ -401,20 +600,34 @@ void AFPS_Character::HandleDeathPayload(const FDeathEventPayload& Data)
 		}), 5.f, false);
 	}
 
-	NetHandleDeathPayload(Data);
+	if (HasAuthority())
+	{
+		DeathEvent.Victim = this;
+		DeathEvent.Instigator = Data.InstigatorController ? Data.InstigatorController->PlayerState : nullptr;
+		DeathEvent.WeaponClass = Data.DamageCauserClass;
+		DeathEvent.HitBoneIndex = GetMesh() ? GetMesh()->GetBoneIndex(Data.BoneName) : INDEX_NONE;
+		DeathEvent.Impulse = Data.Impulse;
+		DeathEvent.HitZone = Data.HitZone;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AFPS_Character, DeathEvent, this);
+
+		OnRep_DeathEvent();
+	}
 }
 
-void AFPS_Character::NetHandleDeathPayload_Implementation(const FDeathEventPayload& Data)
+void AFPS_Character::OnRep_DeathEvent()
 {
+	if (!DeathEvent.IsSet()) return;
+
 	if (IsLocallyControlled()) { SetViewModeTag(GameplayViewModeTags::ThirdPerson); }
 
 	StartRagdollingImplementation();
 
 	if (USkeletalMeshComponent* MeshComp = GetMesh())
 	{
-		if (!Data.Impulse.IsNearlyZero() && MeshComp->IsSimulatingPhysics(Data.BoneName))
+		const FName BoneName = DeathEvent.HitBoneIndex != INDEX_NONE ? MeshComp->GetBoneName(DeathEvent.HitBoneIndex) : FName(TEXT("pelvis"));
+		if (!DeathEvent.Impulse.IsNearlyZero() && MeshComp->IsSimulatingPhysics(BoneName))
 		{
-			MeshComp->AddImpulseAtLocation(Data.Impulse * MeshComp->GetMass(), Data.ImpulseAt, Data.BoneName);
+			MeshComp->AddImpulseAtLocation(DeathEvent.Impulse * MeshComp->GetMass(), MeshComp->GetBoneLocation(BoneName), BoneName);
 		}
 	}
 }
@@ -5,7 +5,62 @@
 #include "Net/UnrealNetwork.h"
 #include "GameFramework/DamageType.h"
 #include "GameFramework/Controller.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkinnedAsset.h"
 #include "Game/FPS_GameMode.h"
+#include "Game/FPS_BoneDamageSubsystem.h"
+#include "Game/FPS_RadialDamageSubsystem.h"
+#include "Misc/GE_Types.h"
+#include "Misc/GE_DamageProfileData.h"
+#include "Equipments/GE_FireWeapon.h"
+#include "Interfaces/GE_CharacterInterface.h"
+
+static EFPS_HitZone FPS_ToHitZone(EGE_DamageZone Zone)
+{
+	switch (Zone)
+	{
+		case EGE_DamageZone::Head:
+			return EFPS_HitZone::Head;
+		case EGE_DamageZone::Arms:
+		case EGE_DamageZone::Legs:
+			return EFPS_HitZone::Limb;
+		default:
+			return EFPS_HitZone::Torso;
+	}
+}
+
+void FFPS_BoneDamageTable::Build(const FReferenceSkeleton& RefSkeleton, TConstArrayView<FBoneDamage> BoneDamage)
+{
+	Settings = BoneDamage;
+
+	const int32 NumBones = RefSkeleton.GetNum();
+
+	TArray<int32> Configured;
+	Configured.Init(INDEX_NONE, NumBones);
+	for (int32 i = 0; i < BoneDamage.Num(); ++i)
+	{
+		const int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneDamage[i].BoneName);
+		if (BoneIndex != INDEX_NONE && Configured[BoneIndex] == INDEX_NONE)
+		{
+			Configured[BoneIndex] = i;
+		}
+	}
+
+	// Parents come before their children, so inheriting from the parent gives the nearest configured ancestor
+	Multipliers.Init(1.f, NumBones);
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		if (Configured[BoneIndex] != INDEX_NONE)
+		{
+			Multipliers[BoneIndex] = BoneDamage[Configured[BoneIndex]].DamageFactor;
+		}
+		else if (ParentIndex != INDEX_NONE)
+		{
+			Multipliers[BoneIndex] = Multipliers[ParentIndex];
+		}
+	}
+}
 
 UFPS_HealthComponent::UFPS_HealthComponent()
 {
@@ -19,6 +74,7 @@ void UFPS_HealthComponent::BeginPlay()
 	Super::BeginPlay();
 
 	Health = FMath::Clamp(Health, 0.0f, MaxHealth);
+	AssistLedger.HalfLife = AssistHalfLife;
 	if (AActor* Owner = GetOwner())
 	{
 		Owner->OnTakeAnyDamage.AddDynamic(this, &UFPS_HealthComponent::HandleAnyDamage);
@@ -61,18 +117,30 @@ void UFPS_HealthComponent::Heal(float Amount)
 	const float Old = Health;
 	SetHealth(Health + Amount);
 
-	if (Health > Old && DamageInfoArray.Num() > 0)
+	if (Health > Old && AssistLedger.Num() > 0)
 	{
 		const float Healed = FMath::Min(Amount, MaxHealth - Old);
 		const float Fraction = Healed / FMath::Max(1.f, MaxHealth);
-		for (int32 i = DamageInfoArray.Num() - 1; i >= 0; --i)
+		AssistLedger.Scale(1.f - Fraction);
+	}
+}
+
+AController* UFPS_HealthComponent::GetTopDamageInstigator() const
+{
+	const FDamageInfo* Top = AssistLedger.GetTopContributor();
+	return Top && Top->IsValid() ? Top->Instigator.Get() : nullptr;
+}
+
+void UFPS_HealthComponent::GetAssistInstigators(AController* Killer, float MinShare, TArray<AController*>& OutAssists) const
+{
+	OutAssists.Reset();
+
+	for (int32 i = 0; i < AssistLedger.Num(); ++i)
+	{
+		const FDamageInfo& Info = AssistLedger.GetEntry(i);
+		if (Info.IsValid() && Info.Instigator != Killer && AssistLedger.GetShare(i) >= MinShare)
 		{
-			FDamageInfo& Info = DamageInfoArray[i];
-			Info.DamageAmount -= Info.DamageAmount * Fraction;
-			if (Info.DamageAmount <= KINDA_SMALL_NUMBER)
-			{
-				DamageInfoArray.RemoveAtSwap(i);
-			}
+			OutAssists.Add(Info.Instigator);
 		}
 	}
 }
@@ -111,14 +179,62 @@ void UFPS_HealthComponent::ApplyFallDamage(float Amount)
 float UFPS_HealthComponent::ApplyDamageEvent(float DamageAmount, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	if (!GetOwner() || GetOwner()->GetLocalRole() < ROLE_Authority) return 0.f;
-	if (!GetOwner()->CanBeDamaged() || DamageAmount <= 0.f || !DamageCauser) return 0.f;
+	// Resolved radial damage lands after its causer may have been destroyed and carries the causer's class instead
+	const bool bCauserRequired = !DamageEvent.IsOfType(FFPS_RadialDamageEvent::ClassID);
+	if (!GetOwner()->CanBeDamaged() || DamageAmount <= 0.f || (bCauserRequired && !DamageCauser)) return 0.f;
 	if (!IsAlive()) return 0.f;
 
 	FHitResult Hit(ForceInit);
 	FVector ImpulseDir = GetOwner()->GetActorForwardVector();
 	bool bRadial = false;
 
-	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	float BoneMultiplier;
+	EFPS_HitZone HitZone;
+
+	// A damage profile's zone table already scaled the shot, PerBoneDamageMultiplier only applies without one
+	const AGE_FireWeapon* Weapon = Cast<AGE_FireWeapon>(DamageCauser);
+	const UGE_DamageProfileData* DamageProfile = Weapon ? Weapon->DamageProfile.Get() : nullptr;
+
+	if (DamageEvent.IsOfType(FGE_ShotDamageEvent::ClassID))
+	{
+		// Weight every pellet by its own bone, the heaviest one stands for the shot and any head pellet makes it a headshot
+		const FGE_ShotDamageEvent* Evt = static_cast<const FGE_ShotDamageEvent*>(&DamageEvent);
+		float Weighted = 0.f;
+		float Heaviest = -1.f;
+		HitZone = EFPS_HitZone::None;
+
+		for (int32 i = 0; i < Evt->PelletHits.Num(); ++i)
+		{
+			float PelletMultiplier;
+			EFPS_HitZone PelletZone;
+			ResolveHitBone(Evt->PelletHits[i], PelletMultiplier, PelletZone);
+			if (DamageProfile) { PelletMultiplier = 1.f; }
+
+			const float PelletDamage = Evt->GetPelletDamage(i) * PelletMultiplier;
+			Weighted += PelletDamage;
+
+			if (PelletDamage > Heaviest)
+			{
+				Heaviest = PelletDamage;
+				Hit = Evt->PelletHits[i].Hit;
+				if (HitZone != EFPS_HitZone::Head) { HitZone = PelletZone; }
+			}
+			if (PelletZone == EFPS_HitZone::Head)
+			{
+				HitZone = PelletZone;
+			}
+		}
+
+		if (Evt->PelletHits.Num() == 0)
+		{
+			Hit = Evt->HitInfo;
+			Weighted = DamageAmount;
+		}
+
+		ImpulseDir = Evt->ShotDirection;
+		BoneMultiplier = Weighted / DamageAmount;
+	}
+	else if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
 	{
 		const FPointDamageEvent* Evt = static_cast<const FPointDamageEvent*>(&DamageEvent);
 		Hit = Evt->HitInfo;
@@ -136,31 +252,25 @@ float UFPS_HealthComponent::ApplyDamageEvent(float DamageAmount, const FDamageEv
 		bRadial = true;
 	}
 
-	DamageAmount *= GetPerBoneMultiplier(Hit.BoneName);
+	if (!DamageEvent.IsOfType(FGE_ShotDamageEvent::ClassID))
+	{
+		ResolveHitBone(Hit, BoneMultiplier, HitZone);
+	}
+
+	DamageAmount *= BoneMultiplier;
+
+	if (Armor > 0.f && DamageProfile)
+	{
+		DamageAmount *= DamageProfile->GetLUT().GetArmorScale(Armor);
+	}
 
 	DamageAmount = AdjustDamage(DamageAmount, EventInstigator);
 
-	const bool bHeadshot = Hit.BoneName.ToString().ToLower().Equals(TEXT("head"));
+	const bool bHeadshot = HitZone == EFPS_HitZone::Head;
 
 	if (DamageAmount > 0.f && EventInstigator)
 	{
-		bool bFound = false;
-		for (FDamageInfo& Info : DamageInfoArray)
-		{
-			if (Info.Instigator == EventInstigator)
-			{
-				Info.DamageTypeClass = DamageEvent.DamageTypeClass;
-				Info.DamageCauser = DamageCauser;
-				Info.DamageAmount += DamageAmount;
-				bFound = true;
-				break;
-			}
-		}
-
-		if (!bFound)
-		{
-			DamageInfoArray.Add(FDamageInfo(EventInstigator, DamageEvent.DamageTypeClass, DamageCauser, DamageAmount, bHeadshot));
-		}
+		AssistLedger.Add(EventInstigator, DamageEvent.DamageTypeClass, DamageCauser, DamageAmount, bHeadshot, GetWorld()->GetTimeSeconds());
 	}
 
 	const float NewHealth = Health - DamageAmount; // Final health value (don't change afterwards)
@@ -181,13 +291,18 @@ float UFPS_HealthComponent::ApplyDamageEvent(float DamageAmount, const FDamageEv
 			const FName Bone = Hit.BoneName.IsNone() ? FName(TEXT("pelvis")) : Hit.BoneName;
 			const FVector At = Hit.Location.IsNearlyZero() ? GetOwner()->GetActorLocation() : Hit.Location;
 
-			const FDeathEventPayload Payload(
+			FDeathEventPayload Payload(
 				EventInstigator,
 				DamageEvent.DamageTypeClass ? DamageEvent.DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass()),
 				DamageCauser,
 				bRadial,
 				Hit, Impulse, At, Bone,
-				DamageAmount, bHeadshot);
+				DamageAmount, HitZone);
+			Payload.DamageCauserClass = DamageCauser ? DamageCauser->GetClass() : nullptr;
+			if (!DamageCauser && DamageEvent.IsOfType(FFPS_RadialDamageEvent::ClassID))
+			{
+				Payload.DamageCauserClass = static_cast<const FFPS_RadialDamageEvent&>(DamageEvent).DamageCauserClass;
+			}
 
 			BroadcastDeathOnce(Payload);
 		}
@@ -297,44 +412,65 @@ void UFPS_HealthComponent::OnRep_Health()
 	}
 }
 
-float UFPS_HealthComponent::GetPerBoneMultiplier(const FName& BoneName) const
+const FFPS_BoneDamageTable* UFPS_HealthComponent::GetBoneDamageTable(const USkinnedAsset*& OutAsset)
 {
-	if (BoneName.IsNone()) return 1.f;
-	
-	const AActor* Owner = GetOwner();
-	if (!Owner) return 1.f;
+	const USkeletalMeshComponent* Skel = DamageMesh.Get();
+	if (!Skel)
+	{
+		const AActor* Owner = GetOwner();
+		Skel = Owner ? Owner->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
+		DamageMesh = Skel;
+	}
 
-	const USkeletalMeshComponent* Skel = Owner->FindComponentByClass<USkeletalMeshComponent>();
-	if (!Skel || !Skel->GetSkinnedAsset()) return 1.f;
+	OutAsset = Skel ? Skel->GetSkinnedAsset() : nullptr;
+	if (!OutAsset) return nullptr;
 
-	const FReferenceSkeleton& RefSkeleton = Skel->GetSkinnedAsset()->GetRefSkeleton();
+	if (!BoneDamageTable.IsValid() || BoneDamageTableAsset.Get() != OutAsset)
+	{
+		UFPS_BoneDamageSubsystem* BoneDamage = GetWorld() ? GetWorld()->GetSubsystem<UFPS_BoneDamageSubsystem>() : nullptr;
+		if (!BoneDamage) return nullptr;
 
-	float DamageFactor = 1.f;
-	int32 MinDepth = MAX_int32;
+		BoneDamageTable = BoneDamage->FindOrBuild(OutAsset, PerBoneDamageMultiplier);
+		BoneDamageTableAsset = OutAsset;
+	}
 
-	const int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName);
-	if (BoneIndex == INDEX_NONE) return 1.f;
+	return BoneDamageTable.Get();
+}
 
-	for (const FBoneDamage& Entry : PerBoneDamageMultiplier)
-	{
-		const int32 ParentIndex = RefSkeleton.FindBoneIndex(Entry.BoneName);
-		if (ParentIndex == INDEX_NONE) continue;
+float UFPS_HealthComponent::GetBoneMultiplier(const FHitResult& Hit, int32 BoneIndex)
+{
+	if (Hit.BoneName.IsNone()) return 1.f;
 
-		const int32 Depth = RefSkeleton.GetDepthBetweenBones(BoneIndex, ParentIndex);
-		if (Depth == 0)
-		{
-			DamageFactor = Entry.DamageFactor;
-			MinDepth = 0;
-			break;
-		}
-		if (Depth > 0 && Depth < MinDepth)
-		{
-			DamageFactor = Entry.DamageFactor;
-			MinDepth = Depth;
-		}
+	const USkinnedAsset* Asset = nullptr;
+	const FFPS_BoneDamageTable* Table = GetBoneDamageTable(Asset);
+	if (!Table) return 1.f;
+
+	// The index the hit carries is only good for the mesh the table was built from
+	const USkinnedMeshComponent* HitMesh = Cast<USkinnedMeshComponent>(Hit.GetComponent());
+	if (BoneIndex == INDEX_NONE || !HitMesh || HitMesh->GetSkinnedAsset() != Asset)
+	{
+		BoneIndex = Asset->GetRefSkeleton().FindBoneIndex(Hit.BoneName);
 	}
 
-	return DamageFactor;
+	return Table->Multipliers.IsValidIndex(BoneIndex) ? Table->Multipliers[BoneIndex] : 1.f;
+}
+
+void UFPS_HealthComponent::ResolveHitBone(const FHitResult& Hit, float& OutMultiplier, EFPS_HitZone& OutZone)
+{
+	OutMultiplier = GetBoneMultiplier(Hit, INDEX_NONE);
+	OutZone = EFPS_HitZone::None;
+
+	if (Hit.BoneName.IsNone()) return;
+
+	// Zones come from the same table the weapons and lag compensation classify hits with
+	const IGE_CharacterInterface* Character = Cast<IGE_CharacterInterface>(GetOwner());
+	OutZone = FPS_ToHitZone(Character ? Character->GetDamageZoneForBone(Hit.BoneName) : EGE_DamageZone::Generic);
+}
+
+void UFPS_HealthComponent::ResolveHitBone(const FGE_ShotHit& ShotHit, float& OutMultiplier, EFPS_HitZone& OutZone)
+{
+	OutMultiplier = GetBoneMultiplier(ShotHit.Hit, ShotHit.BoneIndex);
+	OutZone = ShotHit.Hit.BoneName.IsNone() ? EFPS_HitZone::None : FPS_ToHitZone(ShotHit.DamageZone);
 }
 
 void UFPS_HealthComponent::BroadcastDeathOnce(const FDeathEventPayload& Payload)
@@ -0,0 +1,56 @@
+#include "Game/FPS_BoneDamageSubsystem.h"
+
+#include "Engine/SkinnedAsset.h"
+
+#include "Misc/FPS_Stats.h"
+#include "Components/FPS_HealthComponent.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bone Damage Tables"), STAT_FPS_BoneDamageTables, STATGROUP_FPSGame);
+
+static bool FPS_SameBoneDamage(TConstArrayView<FBoneDamage> A, TConstArrayView<FBoneDamage> B)
+{
+	if (A.Num() != B.Num()) return false;
+
+	for (int32 i = 0; i < A.Num(); ++i)
+	{
+		if (A[i].BoneName != B[i].BoneName || A[i].DamageFactor != B[i].DamageFactor) return false;
+	}
+	return true;
+}
+
+void UFPS_BoneDamageSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_FPS_BoneDamageTables, NumTables);
+	Tables.Empty();
+	NumTables = 0;
+
+	Super::Deinitialize();
+}
+
+bool UFPS_BoneDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TSharedPtr<const FFPS_BoneDamageTable> UFPS_BoneDamageSubsystem::FindOrBuild(const USkinnedAsset* Asset, TConstArrayView<FBoneDamage> BoneDamage)
+{
+	if (!Asset) return nullptr;
+
+	auto& Variants = Tables.FindOrAdd(FObjectKey(Asset));
+	for (const TSharedPtr<const FFPS_BoneDamageTable>& Table : Variants)
+	{
+		if (FPS_SameBoneDamage(Table->Settings, BoneDamage))
+		{
+			return Table;
+		}
+	}
+
+	TSharedRef<FFPS_BoneDamageTable> Table = MakeShared<FFPS_BoneDamageTable>();
+	Table->Build(Asset->GetRefSkeleton(), BoneDamage);
+	Variants.Add(Table);
+
+	++NumTables;
+	INC_DWORD_STAT(STAT_FPS_BoneDamageTables);
+
+	return Table;
+}
@@ -1,9 +1,26 @@
 #include "Game/FPS_GameMode.h"
 
+#include "Engine/AssetManager.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/FPS_Stats.h"
+#include "Player/FPS_PlayerController.h"
+#include "Equipments/GE_Equipment.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Loadout Spawn (ms)"), STAT_FPS_LoadoutSpawn, STATGROUP_FPSGame);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Respawn Wave Longest Hitch (ms)"), STAT_FPS_RespawnWaveHitch, STATGROUP_FPSGame);
+
+static TAutoConsoleVariable<float> CVarRespawnWaveTail(
+	TEXT("FPS.RespawnWave.Tail"),
+	1.0f,
+	TEXT("Seconds without loadout activity before a respawn wave is reported."),
+	ECVF_Default);
+
 AFPS_GameMode::AFPS_GameMode(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 }
 
 void AFPS_GameMode::PreInitializeComponents()
@@ -16,9 +33,29 @@ void AFPS_GameMode::PostInitializeComponents()
 	Super::PostInitializeComponents();
 }
 
+void AFPS_GameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Wall clock, DeltaSeconds is dilated and clamped
+	const double Now = FPlatformTime::Seconds();
+	WaveLongestFrame = FMath::Max(WaveLongestFrame, Now - WaveLastFrameTime);
+	WaveLastFrameTime = Now;
+
+	if (WavePendingLoadouts == 0 && Now - WaveLastActivityTime >= CVarRespawnWaveTail.GetValueOnGameThread())
+	{
+		EndRespawnWave();
+	}
+}
+
 void AFPS_GameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
 {
 	Super::InitGame(MapName, Options, ErrorMessage);
+
+	if (const AFPS_PlayerController* DefaultController = Cast<AFPS_PlayerController>(PlayerControllerClass ? PlayerControllerClass->GetDefaultObject() : nullptr))
+	{
+		PreloadLoadout(DefaultController->LoadoutPresets);
+	}
 }
 
 void AFPS_GameMode::StartPlay()
@@ -34,6 +71,12 @@ APlayerController* AFPS_GameMode::SpawnPlayerController(ENetRole InRemoteRole, c
 void AFPS_GameMode::PostLogin(class APlayerController* NewPlayer)
 {
 	Super::PostLogin(NewPlayer);
+
+	// Usually already resident from InitGame, only differing presets start a new load
+	if (const AFPS_PlayerController* Controller = Cast<AFPS_PlayerController>(NewPlayer))
+	{
+		PreloadLoadout(Controller->LoadoutPresets);
+	}
 }
 
 bool AFPS_GameMode::UpdatePlayerStartSpot(AController* Player, const FString& Portal, FString& OutErrorMessage)
@@ -49,4 +92,62 @@ AActor* AFPS_GameMode::FindPlayerStart_Implementation(AController* Player, const
 void AFPS_GameMode::CalcDamage(float& OutDamageAmount, AController* Controller, AController* OtherController)
 {
 	// #TODO: Finish
+}
+
+void AFPS_GameMode::PreloadLoadout(const FPlayerLoadout& Loadout)
+{
+	TArray<FSoftObjectPath> Paths;
+	for (const TSoftClassPtr<AGE_Equipment>& EquipmentClass : Loadout.Equipments)
+	{
+		if (EquipmentClass.IsNull()) continue;
+
+		bool bAlreadyPreloaded = false;
+		PreloadedPaths.Add(EquipmentClass.ToSoftObjectPath(), &bAlreadyPreloaded);
+		if (!bAlreadyPreloaded)
+		{
+			Paths.Add(EquipmentClass.ToSoftObjectPath());
+		}
+	}
+
+	if (Paths.Num() > 0)
+	{
+		PreloadHandles.Add(UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority));
+	}
+}
+
+void AFPS_GameMode::NotifyLoadoutRequested()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	if (!IsActorTickEnabled())
+	{
+		WaveLoadouts = 0;
+		WaveLongestFrame = 0.0;
+		WaveLongestSpawn = 0.0;
+		WaveLastFrameTime = Now;
+		SetActorTickEnabled(true);
+	}
+
+	++WavePendingLoadouts;
+	++WaveLoadouts;
+	WaveLastActivityTime = Now;
+}
+
+void AFPS_GameMode::NotifyLoadoutFinished(double SpawnSeconds)
+{
+	WavePendingLoadouts = FMath::Max(0, WavePendingLoadouts - 1);
+	WaveLongestSpawn = FMath::Max(WaveLongestSpawn, SpawnSeconds);
+	WaveLastActivityTime = FPlatformTime::Seconds();
+
+	INC_FLOAT_STAT_BY(STAT_FPS_LoadoutSpawn, static_cast<float>(SpawnSeconds * 1000.0));
+}
+
+void AFPS_GameMode::EndRespawnWave()
+{
+	SetActorTickEnabled(false);
+
+	SET_FLOAT_STAT(STAT_FPS_RespawnWaveHitch, static_cast<float>(WaveLongestFrame * 1000.0));
+
+	UE_LOG(LogTemp, Log, TEXT("Respawn wave: %d loadouts, longest frame %.2f ms, longest loadout spawn %.2f ms"),
+		WaveLoadouts, WaveLongestFrame * 1000.0, WaveLongestSpawn * 1000.0);
 }
\ No newline at end of file
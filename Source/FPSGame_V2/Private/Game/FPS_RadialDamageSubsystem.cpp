@@ -0,0 +1,365 @@
+#include "Game/FPS_RadialDamageSubsystem.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/Controller.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/FPS_Stats.h"
+#include "Character/FPS_Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("Radial Damage Query"), STAT_FPS_RadialDamageQuery, STATGROUP_FPSGame);
+DECLARE_CYCLE_STAT(TEXT("Radial Damage Resolve"), STAT_FPS_RadialDamageResolve, STATGROUP_FPSGame);
+DECLARE_CYCLE_STAT(TEXT("Radial Damage Rebucket"), STAT_FPS_RadialDamageRebucket, STATGROUP_FPSGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Radial Damage Tracked"), STAT_FPS_RadialDamageTracked, STATGROUP_FPSGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Traces"), STAT_FPS_RadialDamageTraces, STATGROUP_FPSGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Cell Moves"), STAT_FPS_RadialDamageCellMoves, STATGROUP_FPSGame);
+
+static TAutoConsoleVariable<float> CVarRadialDamageCellSize(
+	TEXT("FPS.RadialDamage.CellSize"),
+	1000.0f,
+	TEXT("Edge of a radial damage grid cell in cm, read when the world starts. Around the usual blast radius works best."),
+	ECVF_Default);
+
+static void FPS_RadialDamageBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 NumBlasts = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 50;
+	const float Radius = Args.Num() > 1 ? FMath::Max(1.0f, FCString::Atof(*Args[1])) : 800.0f;
+
+	UFPS_RadialDamageSubsystem* RadialDamage = World ? World->GetSubsystem<UFPS_RadialDamageSubsystem>() : nullptr;
+	if (!RadialDamage || RadialDamage->GetNumTracked() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Radial damage benchmark needs a server world with characters."));
+		return;
+	}
+
+	TArray<int32> Indices;
+	TArray<float> Distances;
+	TArray<FVector> Origins;
+
+	// Blasts scattered around tracked characters, the usual case for a grenade
+	FRandomStream Stream(NumBlasts);
+	TArray<AActor*> Characters;
+	for (TActorIterator<AFPS_Character> It(World); It; ++It)
+	{
+		Characters.Add(*It);
+	}
+	for (int32 b = 0; b < NumBlasts; ++b)
+	{
+		const AActor* Target = Characters[Stream.RandHelper(Characters.Num())];
+		Origins.Add(Target->GetActorLocation() + Stream.VRand() * Stream.FRandRange(0.0f, Radius));
+	}
+
+	int32 TotalCandidates = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FVector& Origin : Origins)
+	{
+		RadialDamage->GatherInRadius(Origin, Radius, Indices, Distances);
+		TotalCandidates += Indices.Num();
+	}
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Display, TEXT("Radial damage benchmark: %d blasts of %.0f cm over %d characters. %.2f candidates per blast, %.3f us per blast, %.3f ms in total"),
+		NumBlasts, Radius, RadialDamage->GetNumTracked(), static_cast<double>(TotalCandidates) / NumBlasts, Elapsed * 1.0e6 / NumBlasts, Elapsed * 1.0e3);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdRadialDamageBenchmark(
+	TEXT("FPS.RadialDamage.Benchmark"),
+	TEXT("Runs the radial damage grid query for blasts around the current characters and reports the cost per blast. No damage is applied.\nArgs: [Blasts=50] [Radius=800]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FPS_RadialDamageBenchmark));
+
+void UFPS_RadialDamageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CellSize = FMath::Max(100.0f, CVarRadialDamageCellSize.GetValueOnGameThread());
+
+	Characters.Reserve(64);
+	Locations.Reserve(64);
+	CharacterCells.Reserve(64);
+	Hits.Reserve(256);
+}
+
+void UFPS_RadialDamageSubsystem::Deinitialize()
+{
+	Characters.Empty();
+	Locations.Empty();
+	CharacterCells.Empty();
+	Cells.Empty();
+	Blasts.Empty();
+	Hits.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UFPS_RadialDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFPS_RadialDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client) return;
+
+	UpdateCells();
+	ResolveHits();
+
+	SET_DWORD_STAT(STAT_FPS_RadialDamageTracked, Characters.Num());
+}
+
+TStatId UFPS_RadialDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPS_RadialDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UFPS_RadialDamageSubsystem::RegisterCharacter(AFPS_Character* Character)
+{
+	if (!IsValid(Character) || !Character->HasAuthority()) return;
+
+	if (Characters.Contains(Character)) return;
+
+	const FVector Location = Character->GetActorLocation();
+	const FIntPoint Cell = GetCell(Location);
+
+	const int32 Index = Characters.Add(Character);
+	Locations.Add(Location);
+	CharacterCells.Add(Cell);
+	AddToCell(Cell, Index);
+}
+
+void UFPS_RadialDamageSubsystem::UnregisterCharacter(AFPS_Character* Character)
+{
+	const int32 Index = Characters.IndexOfByKey(Character);
+	if (Index != INDEX_NONE)
+	{
+		RemoveAtSwap(Index);
+	}
+}
+
+void UFPS_RadialDamageSubsystem::ApplyRadialDamage(const FVector& Origin, const FRadialDamageParams& Params, TSubclassOf<UDamageType> DamageTypeClass,
+	AActor* DamageCauser, AController* InstigatedBy, ECollisionChannel OcclusionChannel)
+{
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_FPS_RadialDamageQuery);
+
+	GatherInRadius(Origin, Params.OuterRadius, ScratchIndices, ScratchDistances);
+	if (ScratchIndices.Num() == 0) return;
+
+	// Falloff for every candidate in one pass, distances become damage in place
+	for (float& Value : ScratchDistances)
+	{
+		Value = FMath::Lerp(Params.MinimumDamage, Params.BaseDamage, Params.GetDamageScale(Value));
+	}
+
+	const int32 BlastIndex = Blasts.Add(FBlast());
+	FBlast& Blast = Blasts[BlastIndex];
+	Blast.Origin = Origin;
+	Blast.Params = Params;
+	Blast.DamageTypeClass = DamageTypeClass ? DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+	Blast.DamageCauser = DamageCauser;
+	Blast.DamageCauserClass = DamageCauser ? DamageCauser->GetClass() : nullptr;
+	Blast.InstigatedBy = InstigatedBy;
+
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RadialDamageOcclusion), false, DamageCauser);
+
+	for (int32 i = 0; i < ScratchIndices.Num(); ++i)
+	{
+		AFPS_Character* Character = Characters[ScratchIndices[i]].Get();
+		if (!Character || !Character->CanBeDamaged() || ScratchDistances[i] <= 0.f) continue;
+
+		// Only the world occludes, the victim's own body must not
+		FCollisionQueryParams TraceParams = QueryParams;
+		TraceParams.AddIgnoredActor(Character);
+
+		FBlastHit& Hit = Hits.AddDefaulted_GetRef();
+		Hit.Blast = BlastIndex;
+		Hit.Character = Character;
+		Hit.Location = Locations[ScratchIndices[i]];
+		Hit.Damage = ScratchDistances[i];
+		Hit.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Test, Origin, Hit.Location, OcclusionChannel, TraceParams);
+
+		++Blast.NumPending;
+	}
+
+	INC_DWORD_STAT_BY(STAT_FPS_RadialDamageTraces, Blast.NumPending);
+
+	if (Blast.NumPending == 0)
+	{
+		Blasts.RemoveAt(BlastIndex);
+	}
+}
+
+void UFPS_RadialDamageSubsystem::GatherInRadius(const FVector& Origin, float Radius, TArray<int32>& OutIndices, TArray<float>& OutDistances) const
+{
+	OutIndices.Reset();
+	OutDistances.Reset();
+
+	const FIntPoint Min = GetCell(Origin - FVector(Radius));
+	const FIntPoint Max = GetCell(Origin + FVector(Radius));
+	const double RadiusSq = FMath::Square(static_cast<double>(Radius));
+
+	for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+	{
+		for (int32 X = Min.X; X <= Max.X; ++X)
+		{
+			const TArray<int32, TInlineAllocator<8>>* Cell = Cells.Find(FIntPoint(X, Y));
+			if (!Cell) continue;
+
+			for (const int32 Index : *Cell)
+			{
+				const double DistSq = FVector::DistSquared(Locations[Index], Origin);
+				if (DistSq <= RadiusSq)
+				{
+					OutIndices.Add(Index);
+					OutDistances.Add(static_cast<float>(DistSq));
+				}
+			}
+		}
+	}
+
+	for (float& Distance : OutDistances)
+	{
+		Distance = FMath::Sqrt(Distance);
+	}
+}
+
+FIntPoint UFPS_RadialDamageSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UFPS_RadialDamageSubsystem::AddToCell(const FIntPoint& Cell, int32 Index)
+{
+	Cells.FindOrAdd(Cell).Add(Index);
+}
+
+void UFPS_RadialDamageSubsystem::RemoveFromCell(const FIntPoint& Cell, int32 Index)
+{
+	if (TArray<int32, TInlineAllocator<8>>* Entries = Cells.Find(Cell))
+	{
+		Entries->RemoveSingleSwap(Index, EAllowShrinking::No);
+		if (Entries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void UFPS_RadialDamageSubsystem::RemoveAtSwap(int32 Index)
+{
+	RemoveFromCell(CharacterCells[Index], Index);
+
+	// The last character takes over Index, its cell has to follow
+	const int32 Last = Characters.Num() - 1;
+	if (Index != Last)
+	{
+		RemoveFromCell(CharacterCells[Last], Last);
+		AddToCell(CharacterCells[Last], Index);
+	}
+
+	Characters.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Locations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CharacterCells.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void UFPS_RadialDamageSubsystem::UpdateCells()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FPS_RadialDamageRebucket);
+
+	for (int32 i = Characters.Num() - 1; i >= 0; --i)
+	{
+		const AFPS_Character* Character = Characters[i].Get();
+		if (!Character)
+		{
+			RemoveAtSwap(i);
+			continue;
+		}
+
+		Locations[i] = Character->GetActorLocation();
+
+		// Only characters that crossed into another cell touch the grid
+		const FIntPoint Cell = GetCell(Locations[i]);
+		if (Cell != CharacterCells[i])
+		{
+			RemoveFromCell(CharacterCells[i], i);
+			AddToCell(Cell, i);
+			CharacterCells[i] = Cell;
+
+			INC_DWORD_STAT(STAT_FPS_RadialDamageCellMoves);
+		}
+	}
+}
+
+void UFPS_RadialDamageSubsystem::ResolveHits()
+{
+	if (Hits.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_FPS_RadialDamageResolve);
+
+	UWorld* World = GetWorld();
+
+	struct FReadyHit
+	{
+		FBlastHit Hit;
+		FBlast Blast;
+	};
+	TArray<FReadyHit, TInlineAllocator<32>> Ready;
+
+	// Unfinished traces are compacted to the front, finished ones are applied once the list is consistent again
+	int32 NumKept = 0;
+	for (int32 i = 0; i < Hits.Num(); ++i)
+	{
+		FBlastHit& Hit = Hits[i];
+
+		FTraceDatum Datum;
+		const bool bDone = World->QueryTraceData(Hit.Handle, Datum);
+		if (!bDone && World->IsTraceHandleValid(Hit.Handle, false))
+		{
+			if (NumKept != i)
+			{
+				Hits[NumKept] = MoveTemp(Hit);
+			}
+			++NumKept;
+			continue;
+		}
+
+		FBlast& Blast = Blasts[Hit.Blast];
+		const bool bOccluded = !bDone || (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit);
+		if (!bOccluded)
+		{
+			Ready.Add({ Hit, Blast });
+		}
+
+		if (--Blast.NumPending == 0)
+		{
+			Blasts.RemoveAt(Hit.Blast);
+		}
+	}
+	Hits.SetNum(NumKept, EAllowShrinking::No);
+
+	// Damage can kill, respawn or trigger another blast, none of which may touch the list above
+	for (const FReadyHit& Entry : Ready)
+	{
+		AFPS_Character* Character = Entry.Hit.Character.Get();
+		if (!Character || !Character->CanBeDamaged()) continue;
+
+		// Grenades destroy themselves as they go off, so the causer is usually gone by now and only its class is passed on
+		AActor* DamageCauser = Entry.Blast.DamageCauser.Get();
+
+		FFPS_RadialDamageEvent Event;
+		Event.DamageTypeClass = Entry.Blast.DamageTypeClass;
+		Event.Params = Entry.Blast.Params;
+		Event.Origin = Entry.Blast.Origin;
+		Event.DamageCauserClass = Entry.Blast.DamageCauserClass;
+		Event.ComponentHits.Add(FHitResult(Character, Character->GetMesh(), Entry.Hit.Location, (Entry.Blast.Origin - Entry.Hit.Location).GetSafeNormal()));
+
+		Character->TakeDamage(Entry.Hit.Damage, Event, Entry.Blast.InstigatedBy.Get(), DamageCauser);
+	}
+}
@@ -0,0 +1,340 @@
+#include "Game/FPS_SignificanceSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+#include "Misc/FPS_Stats.h"
+#include "Character/FPS_Character.h"
+#include "Camera/FPS_CameraComponent.h"
+#include "Equipments/GE_Equipment.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_FPS_SignificanceUpdate, STATGROUP_FPSGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Full"), STAT_FPS_SignificanceFull, STATGROUP_FPSGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Reduced"), STAT_FPS_SignificanceReduced, STATGROUP_FPSGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Low"), STAT_FPS_SignificanceLow, STATGROUP_FPSGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Significance Dormant"), STAT_FPS_SignificanceDormant, STATGROUP_FPSGame);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Significance Estimated Cost (ms)"), STAT_FPS_SignificanceCost, STATGROUP_FPSGame);
+
+static TAutoConsoleVariable<bool> CVarSignificanceEnabled(
+	TEXT("FPS.Significance.Enabled"),
+	true,
+	TEXT("Lowers the tick rate of remote characters nobody is looking at. Off puts everyone back at full rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceBudgetMs(
+	TEXT("FPS.Significance.BudgetMs"),
+	2.0f,
+	TEXT("Game thread time per frame remote characters may cost before the least significant ones drop a tier."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceAnimCostMs(
+	TEXT("FPS.Significance.AnimCostMs"),
+	0.05f,
+	TEXT("Estimated cost of one full animation update of a character and its equipment, added to the measured tick cost."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceMaxDistance(
+	TEXT("FPS.Significance.MaxDistance"),
+	8000.0f,
+	TEXT("Past this distance in cm characters never tick faster than the Low tier."),
+	ECVF_Default);
+
+namespace FPS_Significance
+{
+	// Seconds between ticks per tier, zero ticks every frame
+	static constexpr float TierIntervals[] = { 0.f, 1.f / 30.f, 1.f / 15.f, 0.25f };
+
+	// Close enough that turning around shows them before the next dormant tick
+	static constexpr float NearDistance = 500.f;
+
+	static float GetUpdatesPerFrame(EFPS_SignificanceTier Tier, float DeltaTime)
+	{
+		const float Interval = TierIntervals[static_cast<int32>(Tier)];
+		return Interval > 0.f ? FMath::Min(1.f, DeltaTime / Interval) : 1.f;
+	}
+
+	static void SetEquipmentInterval(AGE_Equipment* Equipment, float Interval)
+	{
+		Equipment->SetActorTickInterval(Interval);
+		if (USkeletalMeshComponent* Mesh = Equipment->GetMeshFP()) { Mesh->SetComponentTickInterval(Interval); }
+		if (USkeletalMeshComponent* Mesh = Equipment->GetMeshTP()) { Mesh->SetComponentTickInterval(Interval); }
+	}
+}
+
+static void FPS_SignificanceReport(UWorld* World)
+{
+	const UFPS_SignificanceSubsystem* Significance = World ? World->GetSubsystem<UFPS_SignificanceSubsystem>() : nullptr;
+	if (!Significance)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPS.Significance.Report: no significance subsystem in this world"));
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Significance: %d characters. Full %d, Reduced %d, Low %d, Dormant %d. Estimated %.3f of %.3f ms, %.3f ms per character tick"),
+		Significance->GetNumTracked(),
+		Significance->GetNumInTier(EFPS_SignificanceTier::Full),
+		Significance->GetNumInTier(EFPS_SignificanceTier::Reduced),
+		Significance->GetNumInTier(EFPS_SignificanceTier::Low),
+		Significance->GetNumInTier(EFPS_SignificanceTier::Dormant),
+		Significance->GetEstimatedCostMs(), CVarSignificanceBudgetMs.GetValueOnGameThread(), Significance->GetTickCostMs());
+}
+
+static FAutoConsoleCommandWithWorld CmdSignificanceReport(
+	TEXT("FPS.Significance.Report"),
+	TEXT("Prints how many characters sit in each tick tier and the estimated cost against the budget."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&FPS_SignificanceReport));
+
+bool UFPS_SignificanceSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UFPS_SignificanceSubsystem::Deinitialize()
+{
+	for (FEntry& Entry : Entries)
+	{
+		Restore(Entry);
+	}
+	Entries.Empty();
+	Order.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UFPS_SignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFPS_SignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_FPS_SignificanceUpdate);
+
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_DedicatedServer) return;
+
+	if (FrameTicks > 0)
+	{
+		TickCostMs = FMath::Lerp(TickCostMs, static_cast<float>(FrameTickSeconds * 1000.0 / FrameTicks), 0.05f);
+		FrameTickSeconds = 0.0;
+		FrameTicks = 0;
+	}
+
+	for (int32 i = Entries.Num() - 1; i >= 0; --i)
+	{
+		if (!Entries[i].Character.IsValid())
+		{
+			Entries.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		}
+	}
+
+	FMemory::Memzero(TierCounts);
+	EstimatedCostMs = 0.f;
+
+	APlayerController* PC = World->GetFirstPlayerController();
+	if (!CVarSignificanceEnabled.GetValueOnGameThread() || !PC || !PC->IsLocalController())
+	{
+		for (FEntry& Entry : Entries)
+		{
+			Restore(Entry);
+		}
+		TierCounts[static_cast<int32>(EFPS_SignificanceTier::Full)] = Entries.Num();
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const float FOV = PC->PlayerCameraManager ? PC->PlayerCameraManager->GetFOVAngle() : 90.f;
+	const float TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(FOV, 10.f, 170.f) * 0.5f));
+	const AActor* ViewTarget = PC->GetViewTarget();
+
+	// Only simulated proxies are cosmetic, whatever the local player controls, watches or simulates stays at full rate.
+	// So do ragdolls, the mesh tick carries their physics
+	Order.Reset();
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		FEntry& Entry = Entries[i];
+		const AFPS_Character* Character = Entry.Character.Get();
+		if (Character->GetLocalRole() != ROLE_SimulatedProxy || Character == ViewTarget || Character->GetMesh()->IsSimulatingPhysics())
+		{
+			Restore(Entry);
+			++TierCounts[static_cast<int32>(EFPS_SignificanceTier::Full)];
+			continue;
+		}
+
+		Score(Entry, ViewLocation, ViewRotation.Vector(), TanHalfFOV);
+		Order.Add(i);
+	}
+
+	Order.Sort([this](int32 A, int32 B) { return Entries[A].Score > Entries[B].Score; });
+
+	// Most significant first, each takes the best tier it is allowed that still fits what is left of the budget
+	const float FullCostMs = TickCostMs + CVarSignificanceAnimCostMs.GetValueOnGameThread();
+	float RemainingMs = CVarSignificanceBudgetMs.GetValueOnGameThread();
+
+	for (const int32 Index : Order)
+	{
+		FEntry& Entry = Entries[Index];
+
+		EFPS_SignificanceTier Tier = Entry.MinTier;
+		float CostMs = FullCostMs * FPS_Significance::GetUpdatesPerFrame(Tier, DeltaTime);
+		while (Tier != EFPS_SignificanceTier::Dormant && CostMs > RemainingMs)
+		{
+			Tier = static_cast<EFPS_SignificanceTier>(static_cast<uint8>(Tier) + 1);
+			CostMs = FullCostMs * FPS_Significance::GetUpdatesPerFrame(Tier, DeltaTime);
+		}
+
+		RemainingMs -= CostMs;
+		EstimatedCostMs += CostMs;
+		++TierCounts[static_cast<int32>(Tier)];
+
+		Apply(Entry, Tier);
+	}
+
+	SET_DWORD_STAT(STAT_FPS_SignificanceFull, TierCounts[0]);
+	SET_DWORD_STAT(STAT_FPS_SignificanceReduced, TierCounts[1]);
+	SET_DWORD_STAT(STAT_FPS_SignificanceLow, TierCounts[2]);
+	SET_DWORD_STAT(STAT_FPS_SignificanceDormant, TierCounts[3]);
+	SET_FLOAT_STAT(STAT_FPS_SignificanceCost, EstimatedCostMs);
+}
+
+TStatId UFPS_SignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFPS_SignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UFPS_SignificanceSubsystem::RegisterCharacter(AFPS_Character* Character)
+{
+	if (!IsValid(Character)) return;
+
+	if (Entries.ContainsByPredicate([Character](const FEntry& Entry) { return Entry.Character == Character; })) return;
+
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Character = Character;
+	Entry.DefaultAnimTickOption = static_cast<uint8>(Character->GetMesh()->VisibilityBasedAnimTickOption);
+	Entry.DefaultAnimTickOptionFP = Character->GetMeshFP() ? static_cast<uint8>(Character->GetMeshFP()->VisibilityBasedAnimTickOption) : 0;
+}
+
+void UFPS_SignificanceSubsystem::UnregisterCharacter(AFPS_Character* Character)
+{
+	const int32 Index = Entries.IndexOfByPredicate([Character](const FEntry& Entry) { return Entry.Character == Character; });
+	if (Index != INDEX_NONE)
+	{
+		Restore(Entries[Index]);
+		Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+}
+
+EFPS_SignificanceTier UFPS_SignificanceSubsystem::GetTier(const AFPS_Character* Character) const
+{
+	const FEntry* Entry = Entries.FindByPredicate([Character](const FEntry& Entry) { return Entry.Character == Character; });
+	return Entry ? Entry->Tier : EFPS_SignificanceTier::Full;
+}
+
+void UFPS_SignificanceSubsystem::Score(FEntry& Entry, const FVector& ViewLocation, const FVector& ViewDirection, float TanHalfFOV) const
+{
+	const AFPS_Character* Character = Entry.Character.Get();
+	const USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	const FVector ToCharacter = Character->GetActorLocation() - ViewLocation;
+	const float Distance = FMath::Max(1.f, static_cast<float>(ToCharacter.Size()));
+
+	// Bounds radius over the half width of the view at that distance
+	const float ScreenSize = Mesh->Bounds.SphereRadius / (Distance * TanHalfFOV);
+
+	// Full weight inside the view cone, fading to a fifth straight behind
+	const float CosAngle = FVector::DotProduct(ToCharacter / Distance, ViewDirection);
+	const float CosHalfFOV = FMath::InvSqrt(1.f + TanHalfFOV * TanHalfFOV);
+	const float ConeWeight = CosAngle >= CosHalfFOV ? 1.f : FMath::Lerp(0.2f, 1.f, (CosAngle + 1.f) / (CosHalfFOV + 1.f));
+
+	Entry.Score = ScreenSize * ConeWeight;
+
+	if (!Mesh->WasRecentlyRendered(0.2f))
+	{
+		Entry.MinTier = Distance < FPS_Significance::NearDistance ? EFPS_SignificanceTier::Low : EFPS_SignificanceTier::Dormant;
+	}
+	else if (Distance > CVarSignificanceMaxDistance.GetValueOnGameThread())
+	{
+		Entry.MinTier = EFPS_SignificanceTier::Low;
+	}
+	else
+	{
+		Entry.MinTier = ScreenSize >= 0.15f ? EFPS_SignificanceTier::Full
+			: ScreenSize >= 0.05f ? EFPS_SignificanceTier::Reduced
+			: EFPS_SignificanceTier::Low;
+	}
+}
+
+void UFPS_SignificanceSubsystem::Apply(FEntry& Entry, EFPS_SignificanceTier Tier)
+{
+	AFPS_Character* Character = Entry.Character.Get();
+	if (!Character) return;
+
+	AGE_Equipment* Equipment = Character->GetCurrentEquipment();
+
+	// Nothing was touched yet, so full rate is already in place
+	if (!Entry.bApplied && Tier == EFPS_SignificanceTier::Full)
+	{
+		Entry.Tier = Tier;
+		return;
+	}
+
+	if (Entry.bApplied && Entry.Tier == Tier && Entry.Equipment.Get() == Equipment) return;
+
+	const float Interval = FPS_Significance::TierIntervals[static_cast<int32>(Tier)];
+
+	// Holstered or pooled equipment goes back to its own tick rate
+	AGE_Equipment* Previous = Entry.Equipment.Get();
+	if (Previous && Previous != Equipment)
+	{
+		FPS_Significance::SetEquipmentInterval(Previous, 0.f);
+	}
+
+	Character->SetActorTickInterval(Interval);
+	SetMeshInterval(Character->GetMesh(), Interval);
+	SetMeshInterval(Character->GetMeshFP(), Interval);
+	SetMeshInterval(Character->GetCameraComponent(), Interval);
+
+	// Dormant characters are off screen, montages keep their notifies and the pose waits until they are seen again
+	Character->GetMesh()->VisibilityBasedAnimTickOption = Tier == EFPS_SignificanceTier::Dormant
+		? EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered
+		: static_cast<EVisibilityBasedAnimTickOption>(Entry.DefaultAnimTickOption);
+
+	// Only the owner sees the first person mesh, for anyone else it only has to pose while spectated
+	if (USkeletalMeshComponent* MeshFP = Character->GetMeshFP())
+	{
+		MeshFP->VisibilityBasedAnimTickOption = Tier == EFPS_SignificanceTier::Full
+			? static_cast<EVisibilityBasedAnimTickOption>(Entry.DefaultAnimTickOptionFP)
+			: EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	}
+
+	if (Equipment)
+	{
+		FPS_Significance::SetEquipmentInterval(Equipment, Interval);
+	}
+
+	Entry.Tier = Tier;
+	Entry.bApplied = Tier != EFPS_SignificanceTier::Full;
+	Entry.Equipment = Entry.bApplied ? Equipment : nullptr;
+}
+
+void UFPS_SignificanceSubsystem::Restore(FEntry& Entry)
+{
+	Apply(Entry, EFPS_SignificanceTier::Full);
+}
+
+void UFPS_SignificanceSubsystem::SetMeshInterval(USkeletalMeshComponent* Mesh, float Interval)
+{
+	// A skeletal mesh updates its animation from its tick, so the interval is its animation rate
+	if (Mesh)
+	{
+		Mesh->SetComponentTickInterval(Interval);
+	}
+}
@@ -1 +1,249 @@
 #include "Misc/FPS_Types.h"
+
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/HitResult.h"
+#include "UObject/CoreNet.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/BitWriter.h"
+
+template<typename T>
+static void FPS_SerializeObject(FArchive& Ar, UPackageMap* Map, UClass* Class, T*& Object)
+{
+	// Left out when measuring locally without a package map
+	if (!Map) return;
+
+	UObject* Value = Object;
+	Map->SerializeObject(Ar, Class, Value);
+	if (Ar.IsLoading())
+	{
+		Object = Cast<T>(Value);
+	}
+}
+
+bool FFPS_DeathEvent::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	AActor* VictimActor = Victim;
+	APlayerState* InstigatorState = Instigator;
+	UClass* Class = WeaponClass;
+	FPS_SerializeObject(Ar, Map, AActor::StaticClass(), VictimActor);
+	FPS_SerializeObject(Ar, Map, APlayerState::StaticClass(), InstigatorState);
+	FPS_SerializeObject(Ar, Map, UClass::StaticClass(), Class);
+
+	// Shifted by one so the root maps to zero and small indices pack into a byte
+	uint32 PackedBone = static_cast<uint32>(HitBoneIndex + 1);
+	Ar.SerializeIntPacked(PackedBone);
+
+	Impulse.NetSerialize(Ar, Map, bOutSuccess);
+
+	uint8 PackedZone = static_cast<uint8>(HitZone);
+	Ar.SerializeBits(&PackedZone, 2);
+
+	if (Ar.IsLoading())
+	{
+		Victim = VictimActor;
+		Instigator = InstigatorState;
+		WeaponClass = Class && Class->IsChildOf(AActor::StaticClass()) ? Class : nullptr;
+		HitBoneIndex = static_cast<int32>(PackedBone) - 1;
+		HitZone = static_cast<EFPS_HitZone>(PackedZone);
+	}
+
+	return bOutSuccess && !Ar.IsError();
+}
+
+// Estimated size of a packed NetGUID for an object the connection already knows, there is no package map here to ask
+static constexpr int32 FPS_NetGUIDBytes = 2;
+
+// Bone names are not hardcoded names, so they go out as a string plus a number
+static int32 FPS_NetNameBytes(FName Name)
+{
+	return 1 + 4 + Name.GetPlainNameString().Len() + 1 + 4;
+}
+
+static void FPS_DeathBandwidth(const TArray<FString>& Args)
+{
+	const int32 NumKills = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 20;
+	const int32 NumConnections = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 16;
+
+	const FName Bone(TEXT("spine_03"));
+	const FVector TraceStart(0.0, 0.0, 160.0);
+	const FVector TraceEnd(8000.0, 1200.0, 140.0);
+
+	FHitResult Hit(nullptr, nullptr, FMath::Lerp(TraceStart, TraceEnd, 0.25), FVector(-1.0, 0.0, 0.0));
+	Hit.TraceStart = TraceStart;
+	Hit.TraceEnd = TraceEnd;
+	Hit.Distance = FVector::Dist(TraceStart, FVector(Hit.Location));
+	Hit.BoneName = Bone;
+	Hit.FaceIndex = 12;
+
+	const FVector Impulse = (TraceEnd - TraceStart).GetSafeNormal() * 200.0;
+
+	// The old multicast as its RPC sent it: controller, damage type and causer, the hit with its
+	// own three references and bone name, two full vectors, the bone name again, damage and two bools
+	int32 OldBytes = 6 * FPS_NetGUIDBytes + 2 * FPS_NetNameBytes(Bone) + 2 * sizeof(FVector) + sizeof(float) + 1;
+	{
+		FBitWriter Writer(0, true);
+		bool bSuccess;
+		Hit.NetSerialize(Writer, nullptr, bSuccess);
+		OldBytes += FMath::DivideAndRoundUp<int32>(Writer.GetNumBits(), 8);
+	}
+
+	int32 NewBytes = 3 * FPS_NetGUIDBytes;
+	{
+		FFPS_DeathEvent Event;
+		Event.HitBoneIndex = 5;
+		Event.Impulse = Impulse;
+		Event.HitZone = EFPS_HitZone::Torso;
+
+		FBitWriter Writer(0, true);
+		bool bSuccess;
+		Event.NetSerialize(Writer, nullptr, bSuccess);
+		NewBytes += FMath::DivideAndRoundUp<int32>(Writer.GetNumBits(), 8);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Death event estimate, object references at %d bytes each: ~%d bytes per kill, was ~%d. A %d kill wave to %d connections: ~%d bytes, was ~%d. Relevancy only lowers the new figure"),
+		FPS_NetGUIDBytes, NewBytes, OldBytes, NumKills, NumConnections, NewBytes * NumKills * NumConnections, OldBytes * NumKills * NumConnections);
+}
+
+static FAutoConsoleCommand CmdDeathBandwidth(
+	TEXT("FPS.Death.Bandwidth"),
+	TEXT("Estimates the bytes a death wave sends with the compact death event against the old multicast payload.\nArgs: [Kills=20] [Connections=16]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FPS_DeathBandwidth));
+
+void FFPS_AssistLedger::Add(AController* Instigator, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, float DamageAmount, bool bHeadshot, float Now)
+{
+	if (!Instigator || DamageAmount <= 0.f) return;
+
+	// Weights grow by 2^(elapsed / HalfLife), pull them back long before a float would overflow
+	if ((Now - Epoch) / HalfLife > 32.f)
+	{
+		Rebase(Now);
+	}
+
+	int32 Slot = INDEX_NONE;
+	int32 Weakest = INDEX_NONE;
+	bool bEvicted = false;
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		if (Entries[i].Instigator == Instigator)
+		{
+			Slot = i;
+			break;
+		}
+		if (Weakest == INDEX_NONE || Weights[i] < Weights[Weakest])
+		{
+			Weakest = i;
+		}
+	}
+
+	if (Slot == INDEX_NONE)
+	{
+		if (NumEntries < Capacity)
+		{
+			Slot = NumEntries++;
+		}
+		else
+		{
+			Slot = Weakest;
+			TotalWeight -= Weights[Slot];
+			bEvicted = true;
+		}
+
+		Entries[Slot] = FDamageInfo(Instigator, DamageTypeClass, DamageCauser, 0.f, false);
+		Weights[Slot] = 0.f;
+	}
+
+	FDamageInfo& Info = Entries[Slot];
+	Info.DamageTypeClass = DamageTypeClass;
+	Info.DamageCauser = DamageCauser;
+	Info.DamageAmount += DamageAmount;
+	Info.bHeadshot = bHeadshot;
+
+	const float Weight = DamageAmount * FMath::Exp2((Now - Epoch) / HalfLife);
+	Weights[Slot] += Weight;
+	TotalWeight += Weight;
+
+	// Only the slot just written can have grown, unless it evicted the top
+	if (bEvicted && TopIndex == Slot)
+	{
+		RefreshTop();
+	}
+	else if (TopIndex == INDEX_NONE || Weights[Slot] > Weights[TopIndex])
+	{
+		TopIndex = Slot;
+	}
+}
+
+void FFPS_AssistLedger::Scale(float Factor)
+{
+	TotalWeight = 0.f;
+	for (int32 i = NumEntries - 1; i >= 0; --i)
+	{
+		Entries[i].DamageAmount *= Factor;
+		Weights[i] *= Factor;
+
+		if (Entries[i].DamageAmount <= KINDA_SMALL_NUMBER)
+		{
+			RemoveAtSwap(i);
+			continue;
+		}
+		TotalWeight += Weights[i];
+	}
+
+	RefreshTop();
+}
+
+void FFPS_AssistLedger::Reset()
+{
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		Entries[i] = FDamageInfo();
+		Weights[i] = 0.f;
+	}
+
+	TotalWeight = 0.f;
+	NumEntries = 0;
+	TopIndex = INDEX_NONE;
+}
+
+void FFPS_AssistLedger::Rebase(float Now)
+{
+	const float Factor = FMath::Exp2((Epoch - Now) / HalfLife);
+
+	TotalWeight = 0.f;
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		Weights[i] *= Factor;
+		TotalWeight += Weights[i];
+	}
+
+	Epoch = Now;
+}
+
+void FFPS_AssistLedger::RemoveAtSwap(int32 Index)
+{
+	const int32 Last = --NumEntries;
+	if (Index != Last)
+	{
+		Entries[Index] = Entries[Last];
+		Weights[Index] = Weights[Last];
+	}
+
+	Entries[Last] = FDamageInfo();
+	Weights[Last] = 0.f;
+}
+
+void FFPS_AssistLedger::RefreshTop()
+{
+	TopIndex = INDEX_NONE;
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		if (TopIndex == INDEX_NONE || Weights[i] > Weights[TopIndex])
+		{
+			TopIndex = i;
+		}
+	}
+}
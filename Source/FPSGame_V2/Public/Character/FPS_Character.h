@@ -6,6 +6,7 @@
 #include "Character/GL_Character.h"
 #include "Interfaces/GE_CharacterInterface.h"
 #include "Misc/FPS_Types.h"
+#include "Engine/StreamableManager.h"
 #include "FPS_Character.generated.h"
 
 class UInputMappingContext;
@@ -15,6 +16,8 @@ class UFPS_CameraComponent;
 class UFPS_HealthComponent;
 struct FDeathEventPayload;
 class UGE_EquipmentManagerComponent;
+class UGA_RecoilComponent;
+class UFPS_SignificanceSubsystem;
 
 UCLASS()
 class FPSGAME_V2_API AFPS_Character : public AGL_Character
@@ -47,6 +50,14 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category="Settings|Animation")
 	TObjectPtr<UAnimSequence> EmptyPoseTP;
 
+	/** Bones that start a damage zone, every descendant bone inherits the zone of its closest listed ancestor. */
+	UPROPERTY(EditDefaultsOnly, Category="Settings|Damage")
+	TMap<FName, EGE_DamageZone> DamageZoneBones;
+
+	// Time the body keeps its equipment after death before it goes back to the pool, below zero keeps it until destroyed
+	UPROPERTY(EditDefaultsOnly, Category="Settings|Damage", meta=(Units="Seconds"))
+	float EquipmentReleaseDelay = 5.0f;
+
 	UPROPERTY(EditDefaultsOnly, Category="Settings|Input")
 	TObjectPtr<UInputMappingContext> DefaultMappingContext;
 	
@@ -93,6 +104,7 @@ public:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
 	virtual void BecomeViewTarget(APlayerController* PC) override;
 	virtual void EndViewTarget(APlayerController* PC) override;
@@ -130,6 +142,10 @@ public:
 	virtual void SetIsAimingEquipment(bool bNewIsAiming) override { SetAiming(bNewIsAiming); }
 
 	virtual bool ShouldUseRunFireDelay() const override;
+
+	virtual EGE_DamageZone GetDamageZoneForBone(FName BoneName) const override;
+
+	virtual void OnWeaponFired(AGE_FireWeapon* Weapon, uint16 ShotSequence, int32 ShotIndex) override;
 	//~ IGE_CharacterInterface
 
 protected:
@@ -142,15 +158,39 @@ protected:
 	UPROPERTY(Replicated)
 	int32 EquipmentsCount;
 
+	// Loadout waiting on its classes to stream in
+	TArray<TSoftClassPtr<AGE_Equipment>> PendingLoadout;
+	TSharedPtr<FStreamableHandle> LoadoutHandle;
+
+	/** Spawns PendingLoadout once every class is resident. */
+	void SpawnPendingLoadout();
+	void CancelPendingLoadout();
+
+	// Damage zone per mesh bone index, baked from DamageZoneBones
+	TArray<EGE_DamageZone> BoneDamageZones;
+
+	void BuildBoneDamageZones();
+
+	// Optional, added in Blueprint alongside the other procedural motion components
+	UPROPERTY(Transient)
+	TObjectPtr<UGA_RecoilComponent> RecoilComponent;
+
+	// Null on dedicated servers, fed with this character's tick cost
+	TWeakObjectPtr<UFPS_SignificanceSubsystem> Significance;
+
 public:
 	virtual void PopulateLoadout(const FPlayerLoadout& PlayerLoadout);
 
 protected:
+	// Set once when the character dies, so late and newly relevant clients still see the ragdoll
+	UPROPERTY(ReplicatedUsing=OnRep_DeathEvent)
+	FFPS_DeathEvent DeathEvent;
+
 	UFUNCTION()
 	void HandleDeathPayload(const FDeathEventPayload& Data);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void NetHandleDeathPayload(const FDeathEventPayload& Data);
+	UFUNCTION()
+	void OnRep_DeathEvent();
 	
 	UFUNCTION()
 	void OnEquipmentChanged(AGE_Equipment* NewEquipment, AGE_Equipment* OldEquipment);
@@ -177,6 +217,8 @@ protected:
 public:
 	UFUNCTION(BlueprintPure, Category="Character|Animation")
 	const FAnimState& GetAnimState() const { return AnimState; }
+
+	UFPS_CameraComponent* GetCameraComponent() const { return CameraComponent; }
 	
 	UFUNCTION(BlueprintPure, Category="Character")
 	bool IsOnFirstPersonView() const;
@@ -9,6 +9,10 @@
 #include "FPS_HealthComponent.generated.h"
 
 class UDamageType;
+class USkinnedAsset;
+class USkeletalMeshComponent;
+struct FReferenceSkeleton;
+struct FGE_ShotHit;
 
 USTRUCT(BlueprintType)
 struct FDeathEventPayload
@@ -24,6 +28,10 @@ struct FDeathEventPayload
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
 	TObjectPtr<AActor> DamageCauser;
 
+	// Still set when the causer itself is gone, like a grenade that went off
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	TSubclassOf<AActor> DamageCauserClass;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
 	bool bRadial;
 
@@ -45,6 +53,9 @@ struct FDeathEventPayload
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
 	bool bHeadshot;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults)
+	EFPS_HitZone HitZone;
+
 	FDeathEventPayload()
 		: bRadial(false)
 		, Impulse(FVector::ZeroVector)
@@ -52,14 +63,15 @@ struct FDeathEventPayload
 		, BoneName(NAME_None)
 		, FinalDamage(0.0f)
 		, bHeadshot(false)
+		, HitZone(EFPS_HitZone::None)
 	{}
 
 	FDeathEventPayload(AController* InCtl, TSubclassOf<UDamageType> InDT, AActor* InCauser, bool bInExplosive,
 		const FHitResult& InHit, const FVector& InImpulse, const FVector& InImpulseAt, const FName& InBone,
-		float InFinalDamage, bool bInHeadshot)
+		float InFinalDamage, EFPS_HitZone InHitZone)
 		: InstigatorController(InCtl), DamageType(InDT), DamageCauser(InCauser), bRadial(bInExplosive)
 		, Hit(InHit), Impulse(InImpulse), ImpulseAt(InImpulseAt), BoneName(InBone)
-		, FinalDamage(InFinalDamage), bHeadshot(bInHeadshot)
+		, FinalDamage(InFinalDamage), bHeadshot(InHitZone == EFPS_HitZone::Head), HitZone(InHitZone)
 	{}
 };
 
@@ -76,6 +88,17 @@ struct FBoneDamage
 
 };
 
+/** PerBoneDamageMultiplier resolved for every bone of one mesh, indexed like its reference skeleton. */
+struct FFPS_BoneDamageTable
+{
+	TArray<float> Multipliers;
+
+	// Settings it was built from, to tell variants on the same mesh apart
+	TArray<FBoneDamage> Settings;
+
+	void Build(const FReferenceSkeleton& RefSkeleton, TConstArrayView<FBoneDamage> BoneDamage);
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHealthChanged, float, NewHealth);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDeath);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnTookDamage, const FHitResult&, Hit, float, DamageAmount, AActor*, DamageCauser);
@@ -96,9 +119,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings")
 	float DamageableTimeAfterSpawn = 0.0f;
 	
+	// Ignored for shots from a weapon with a damage profile, its zone table scales those
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings")
 	TArray<FBoneDamage> PerBoneDamageMultiplier;
-	
+
+	// Mitigated through the damage profile of the weapon that hits
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings", meta=(ClampMin="0"))
+	float Armor = 0.0f;
+
+	// Time for an instigator's share of the damage to halve, for kill credit and assists
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings", meta=(ClampMin="0.1", Units="Seconds"))
+	float AssistHalfLife = 10.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Settings")
 	float BulletImpulseScale = 200.0f;
 	
@@ -155,6 +187,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Health", BlueprintAuthorityOnly)
 	void ApplyFallDamage(float Amount);
 
+	/** Instigator with the largest decayed share of the damage taken, for kill credit. */
+	UFUNCTION(BlueprintPure, Category="Health")
+	AController* GetTopDamageInstigator() const;
+
+	/** Instigators other than Killer whose share of the damage taken is at least MinShare. */
+	UFUNCTION(BlueprintCallable, Category="Health")
+	void GetAssistInstigators(AController* Killer, float MinShare, TArray<AController*>& OutAssists) const;
+
+	const FFPS_AssistLedger& GetAssistLedger() const { return AssistLedger; }
+
 	// For owners that still override TakeDamage and want to forward explicitly.
 	UFUNCTION(BlueprintCallable, Category="Health", BlueprintAuthorityOnly)
 	float ApplyDamageEvent(float DamageAmount, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
@@ -164,12 +206,17 @@ protected:
 	float Health = 100.0f;
 	
 	UPROPERTY(BlueprintReadOnly, Category="Health")
-	TArray<FDamageInfo> DamageInfoArray;
+	FFPS_AssistLedger AssistLedger;
 
 	bool bDeathBroadcasted = false;
 
 	FTimerHandle TimerHandle_Damageable;
 
+	// Shared with every health component on the same mesh and settings
+	TSharedPtr<const FFPS_BoneDamageTable> BoneDamageTable;
+	TWeakObjectPtr<const USkinnedAsset> BoneDamageTableAsset;
+	TWeakObjectPtr<const USkeletalMeshComponent> DamageMesh;
+
 protected:
 	UFUNCTION(BlueprintNativeEvent, Category="Health")
 	float AdjustDamage(float InDamage, AController* InstigatorController);
@@ -197,7 +244,11 @@ protected:
 	UFUNCTION()
 	void OnRep_Health();
 
-	float GetPerBoneMultiplier(const FName& BoneName) const;
+	const FFPS_BoneDamageTable* GetBoneDamageTable(const USkinnedAsset*& OutAsset);
+	// BoneIndex is the hit's own, INDEX_NONE to look the bone up by name
+	float GetBoneMultiplier(const FHitResult& Hit, int32 BoneIndex);
+	void ResolveHitBone(const FHitResult& Hit, float& OutMultiplier, EFPS_HitZone& OutZone);
+	void ResolveHitBone(const FGE_ShotHit& ShotHit, float& OutMultiplier, EFPS_HitZone& OutZone);
 	void BroadcastDeathOnce(const FDeathEventPayload& Payload);
 	void BroadcastTookDamage(const FHitResult& Hit, float Amount, AActor* Causer);
 		
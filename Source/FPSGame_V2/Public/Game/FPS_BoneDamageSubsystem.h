@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "FPS_BoneDamageSubsystem.generated.h"
+
+class USkinnedAsset;
+struct FBoneDamage;
+struct FFPS_BoneDamageTable;
+
+/**
+ * Bone damage tables shared by every health component on the same mesh and settings. Built on the first hit,
+ * dropped with the world so PIE sessions and reimported meshes never see stale ones.
+ */
+UCLASS()
+class FPSGAME_V2_API UFPS_BoneDamageSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+public:
+	TSharedPtr<const FFPS_BoneDamageTable> FindOrBuild(const USkinnedAsset* Asset, TConstArrayView<FBoneDamage> BoneDamage);
+
+	int32 GetNumTables() const { return NumTables; }
+
+protected:
+	// Every settings variant built for a mesh, usually one
+	TMap<FObjectKey, TArray<TSharedPtr<const FFPS_BoneDamageTable>, TInlineAllocator<2>>> Tables;
+	int32 NumTables = 0;
+};
@@ -2,6 +2,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/FPS_Types.h"
 #include "FPS_GameMode.generated.h"
 
 UCLASS()
@@ -15,6 +17,7 @@ public:
 	//~ AActor
 	virtual void PreInitializeComponents() override;
 	virtual void PostInitializeComponents() override;
+	virtual void Tick(float DeltaSeconds) override;
 	//~ End of AActor
 
 	//~ AGameModeBase
@@ -28,5 +31,27 @@ public:
 
 public:
 	virtual void CalcDamage(float& OutDamageAmount, AController* Controller, AController* OtherController);
+
+public:
+	/** Streams a loadout's classes in and keeps them resident, so spawning it never waits on disk. */
+	void PreloadLoadout(const FPlayerLoadout& Loadout);
+
+	// Respawn wave tracking, called by AFPS_Character::PopulateLoadout
+	void NotifyLoadoutRequested();
+	void NotifyLoadoutFinished(double SpawnSeconds);
+
+protected:
+	TArray<TSharedPtr<FStreamableHandle>> PreloadHandles;
+	TSet<FSoftObjectPath> PreloadedPaths;
+
+	// A wave lasts while loadouts are pending, plus a short tail for the frames right after the spawns
+	int32 WavePendingLoadouts = 0;
+	int32 WaveLoadouts = 0;
+	double WaveLastActivityTime = 0.0;
+	double WaveLastFrameTime = 0.0;
+	double WaveLongestFrame = 0.0;
+	double WaveLongestSpawn = 0.0;
+
+	void EndRespawnWave();
 	
 };
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/DamageEvents.h"
+#include "WorldCollision.h"
+#include "FPS_RadialDamageSubsystem.generated.h"
+
+class AFPS_Character;
+
+/**
+ * Radial damage whose falloff and occlusion UFPS_RadialDamageSubsystem already resolved, the amount is final.
+ * It lands a frame after the blast, when the causer may be gone, so it carries the causer's class and needs no live causer.
+ */
+USTRUCT()
+struct FFPS_RadialDamageEvent : public FRadialDamageEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AActor> DamageCauserClass;
+
+	static const int32 ClassID = 0x46505244;
+
+	virtual int32 GetTypeID() const override { return FFPS_RadialDamageEvent::ClassID; }
+	virtual bool IsOfType(int32 InID) const override { return FFPS_RadialDamageEvent::ClassID == InID || FRadialDamageEvent::IsOfType(InID); }
+};
+
+/**
+ * Server side radial damage against characters. Characters live in a uniform grid over XY that only
+ * rebuckets them when they cross a cell, so a blast looks at the few cells it covers instead of overlapping the scene.
+ * Occlusion for every victim of every blast in a frame goes out as one async trace set, damage lands next frame.
+ */
+UCLASS()
+class FPSGAME_V2_API UFPS_RadialDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End of FTickableGameObject
+
+public:
+	void RegisterCharacter(AFPS_Character* Character);
+	void UnregisterCharacter(AFPS_Character* Character);
+
+	/** Damages every registered character within Params.OuterRadius of Origin that OcclusionChannel does not block. Authority only. */
+	void ApplyRadialDamage(const FVector& Origin, const FRadialDamageParams& Params, TSubclassOf<UDamageType> DamageTypeClass,
+		AActor* DamageCauser, AController* InstigatedBy, ECollisionChannel OcclusionChannel = ECC_Visibility);
+
+	/** Registered characters inside Radius of Origin, with their distance. No occlusion. */
+	void GatherInRadius(const FVector& Origin, float Radius, TArray<int32>& OutIndices, TArray<float>& OutDistances) const;
+
+	int32 GetNumTracked() const { return Characters.Num(); }
+	int32 GetNumInFlight() const { return Hits.Num(); }
+
+protected:
+	struct FBlast
+	{
+		FVector Origin = FVector::ZeroVector;
+		FRadialDamageParams Params;
+		TSubclassOf<UDamageType> DamageTypeClass;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TSubclassOf<AActor> DamageCauserClass;
+		TWeakObjectPtr<AController> InstigatedBy;
+		int32 NumPending = 0;
+	};
+
+	struct FBlastHit
+	{
+		int32 Blast = INDEX_NONE;
+		TWeakObjectPtr<AFPS_Character> Character;
+		FVector Location = FVector::ZeroVector;
+		float Damage = 0.f;
+		FTraceHandle Handle;
+	};
+
+	// Registered characters, the cell each was last bucketed in, kept in step
+	TArray<TWeakObjectPtr<AFPS_Character>> Characters;
+	TArray<FVector> Locations;
+	TArray<FIntPoint> CharacterCells;
+
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> Cells;
+	float CellSize = 1000.f;
+
+	// Blast slots are reused once all of their hits resolve
+	TSparseArray<FBlast> Blasts;
+	TArray<FBlastHit> Hits;
+
+	// Scratch, kept to avoid reallocating every blast
+	TArray<int32> ScratchIndices;
+	TArray<float> ScratchDistances;
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void AddToCell(const FIntPoint& Cell, int32 Index);
+	void RemoveFromCell(const FIntPoint& Cell, int32 Index);
+	void RemoveAtSwap(int32 Index);
+
+	void UpdateCells();
+	void ResolveHits();
+};
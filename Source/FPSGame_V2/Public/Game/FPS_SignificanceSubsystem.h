@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FPS_SignificanceSubsystem.generated.h"
+
+class AFPS_Character;
+class AGE_Equipment;
+class USkeletalMeshComponent;
+
+UENUM()
+enum class EFPS_SignificanceTier : uint8
+{
+	Full,
+	Reduced,
+	Low,
+	Dormant
+};
+
+/**
+ * Scores remote characters against the local view by screen size, view cone and rendering, then hands out tick tiers
+ * best first until the estimated game thread cost reaches FPS.Significance.BudgetMs. A tier sets the tick interval of
+ * the character, its meshes and camera, and its current equipment. Not created for dedicated servers.
+ */
+UCLASS()
+class FPSGAME_V2_API UFPS_SignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ UWorldSubsystem
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End of UWorldSubsystem
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End of FTickableGameObject
+
+public:
+	void RegisterCharacter(AFPS_Character* Character);
+	void UnregisterCharacter(AFPS_Character* Character);
+
+	/** Game thread time one character tick took, feeds the cost estimate. */
+	void AddTickCost(double Seconds) { FrameTickSeconds += Seconds; ++FrameTicks; }
+
+	EFPS_SignificanceTier GetTier(const AFPS_Character* Character) const;
+
+	int32 GetNumTracked() const { return Entries.Num(); }
+	int32 GetNumInTier(EFPS_SignificanceTier Tier) const { return TierCounts[static_cast<int32>(Tier)]; }
+	float GetEstimatedCostMs() const { return EstimatedCostMs; }
+	float GetTickCostMs() const { return TickCostMs; }
+
+protected:
+	struct FEntry
+	{
+		TWeakObjectPtr<AFPS_Character> Character;
+		TWeakObjectPtr<AGE_Equipment> Equipment;
+		float Score = 0.f;
+		EFPS_SignificanceTier MinTier = EFPS_SignificanceTier::Full;
+		EFPS_SignificanceTier Tier = EFPS_SignificanceTier::Full;
+		uint8 DefaultAnimTickOption = 0;
+		uint8 DefaultAnimTickOptionFP = 0;
+		bool bApplied = false;
+	};
+
+	TArray<FEntry> Entries;
+	TArray<int32> Order;
+
+	// Measured cost of one character tick, smoothed, in ms
+	float TickCostMs = 0.05f;
+	double FrameTickSeconds = 0.0;
+	int32 FrameTicks = 0;
+
+	float EstimatedCostMs = 0.f;
+	int32 TierCounts[4] = {};
+
+	void Score(FEntry& Entry, const FVector& ViewLocation, const FVector& ViewDirection, float TanHalfFOV) const;
+	void Apply(FEntry& Entry, EFPS_SignificanceTier Tier);
+	void Restore(FEntry& Entry);
+
+	static void SetMeshInterval(USkeletalMeshComponent* Mesh, float Interval);
+};
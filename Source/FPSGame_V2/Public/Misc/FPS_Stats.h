@@ -0,0 +1,6 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("FPSGame"), STATGROUP_FPSGame, STATCAT_Advanced);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
 
 #include "FPS_Types.generated.h"
 
@@ -11,6 +12,60 @@
 #endif // IMGUI_API
 
 class AGE_Equipment;
+class APlayerState;
+class AController;
+class UDamageType;
+
+UENUM(BlueprintType)
+enum class EFPS_HitZone : uint8
+{
+	None,
+	Head,
+	Torso,
+	Limb
+};
+
+/** What other clients need of a death: enough to start the ragdoll and show a killfeed entry. */
+USTRUCT(BlueprintType)
+struct FFPS_DeathEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	TObjectPtr<AActor> Victim = nullptr;
+
+	// The killer's controller never reaches other clients, its player state does
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	TObjectPtr<APlayerState> Instigator = nullptr;
+
+	// Class of the damage causer, sent as its NetGUID
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	TSubclassOf<AActor> WeaponClass;
+
+	// Index into the victim's mesh, INDEX_NONE for the root
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	int32 HitBoneIndex = INDEX_NONE;
+
+	// Velocity change at the hit bone, whole units
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	FVector_NetQuantize Impulse = FVector_NetQuantize::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category=Defaults)
+	EFPS_HitZone HitZone = EFPS_HitZone::None;
+
+	bool IsSet() const { return Victim != nullptr; }
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFPS_DeathEvent> : public TStructOpsTypeTraitsBase2<FFPS_DeathEvent>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
 
 USTRUCT(BlueprintType)
 struct FDamageInfo
@@ -53,6 +108,56 @@ struct FDamageInfo
 	}
 };
 
+/**
+ * Damage taken per instigator, capped at Capacity entries stored inline. Contributions decay with HalfLife.
+ * Weights are kept relative to a shared epoch, so decay never reorders them and the top contributor stays cached.
+ */
+USTRUCT(BlueprintType)
+struct FFPS_AssistLedger
+{
+	GENERATED_BODY()
+
+	static constexpr int32 Capacity = 8;
+
+	// DamageAmount is what the instigator dealt in total, before decay. Static arrays stay out of Blueprint
+	UPROPERTY(VisibleInstanceOnly, Category=Defaults)
+	FDamageInfo Entries[Capacity];
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Defaults, meta=(ClampMin=0.1, Units="Seconds"))
+	float HalfLife = 10.0f;
+
+	/** Adds to the instigator's entry, or takes the weakest slot once the ledger is full. */
+	void Add(AController* Instigator, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, float DamageAmount, bool bHeadshot, float Now);
+
+	/** Scales every contribution, dropping the ones that vanish. Healing uses it to forgive damage evenly. */
+	void Scale(float Factor);
+
+	void Reset();
+
+	int32 Num() const { return NumEntries; }
+	const FDamageInfo& GetEntry(int32 Index) const { return Entries[Index]; }
+
+	/** Entry with the largest decayed contribution, or null when empty. */
+	const FDamageInfo* GetTopContributor() const { return TopIndex != INDEX_NONE ? &Entries[TopIndex] : nullptr; }
+
+	/** Fraction of the decayed total that the entry accounts for. */
+	float GetShare(int32 Index) const { return TotalWeight > 0.f ? Weights[Index] / TotalWeight : 0.f; }
+
+	/** Decayed damage the entry still accounts for at Now. */
+	float GetContribution(int32 Index, float Now) const { return Weights[Index] * FMath::Exp2((Epoch - Now) / HalfLife); }
+
+private:
+	float Weights[Capacity] = {};
+	float TotalWeight = 0.f;
+	float Epoch = 0.f;
+	int32 NumEntries = 0;
+	int32 TopIndex = INDEX_NONE;
+
+	void Rebase(float Now);
+	void RemoveAtSwap(int32 Index);
+	void RefreshTop();
+};
+
 USTRUCT(BlueprintType)
 struct FAnimState
 {